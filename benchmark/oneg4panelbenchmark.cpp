@@ -0,0 +1,567 @@
+/* benchmark/oneg4panelbenchmark.cpp
+ * End to end taskbar scalability benchmark
+ */
+
+/*
+ * Starts Xvfb, plays the part of the window manager on it and runs the panel with only the
+ * taskbar against it. For every requested window count it measures:
+ *
+ *   populate   time from mapping the windows to the last repaint of the panel before it
+ *              settles down (no damage for --quiet milliseconds)
+ *   latency    time from a title, icon or urgency change of one window to the next repaint
+ *              of the panel, median and 95th percentile over --events changes
+ *   RSS        resident set size of the panel once populated, and its growth over the idle
+ *              panel started for that round
+ *
+ * Repaints are observed through the DAMAGE extension on the panel's top level window.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QProcess>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+#include <xcb/damage.h>
+#include <xcb/xcb.h>
+
+#include <poll.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kIconSize = 16;
+constexpr quint32 kUrgencyHint = 1 << 8;  // XUrgencyHint in WM_HINTS.flags
+
+double msecsBetween(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+/*!
+ * \brief Headless X server with just enough of an EWMH window manager for the taskbar.
+ *
+ * There is no real window manager: all client windows belong to the benchmark, so it keeps
+ * _NET_CLIENT_LIST up to date and sets WM_STATE itself, the panel can't tell the difference.
+ */
+class FakeDesktop {
+ public:
+  ~FakeDesktop() {
+    if (mConnection)
+      xcb_disconnect(mConnection);
+    if (mXvfb.state() != QProcess::NotRunning) {
+      mXvfb.terminate();
+      if (!mXvfb.waitForFinished(3000))
+        mXvfb.kill();
+    }
+  }
+
+  bool start(const QString& xvfb) {
+    // first display without a socket
+    for (mDisplay = 90; QFile::exists(QStringLiteral("/tmp/.X11-unix/X%1").arg(mDisplay)); ++mDisplay) {
+    }
+
+    mXvfb.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    mXvfb.start(xvfb, {display(), QStringLiteral("-screen"), QStringLiteral("0"), QStringLiteral("1920x1080x24"),
+                       QStringLiteral("-nolisten"), QStringLiteral("tcp"), QStringLiteral("-noreset")});
+    if (!mXvfb.waitForStarted()) {
+      qWarning("Cannot start %s", qPrintable(xvfb));
+      return false;
+    }
+
+    for (int i = 0; i < 100 && !mConnection; ++i) {
+      QThread::msleep(50);
+      xcb_connection_t* connection = xcb_connect(qPrintable(display()), nullptr);
+      if (xcb_connection_has_error(connection))
+        xcb_disconnect(connection);
+      else
+        mConnection = connection;
+    }
+    if (!mConnection) {
+      qWarning("Cannot connect to %s", qPrintable(display()));
+      return false;
+    }
+
+    mScreen = xcb_setup_roots_iterator(xcb_get_setup(mConnection)).data;
+    internAtoms();
+    setupRoot();
+    return true;
+  }
+
+  QString display() const { return QStringLiteral(":%1").arg(mDisplay); }
+  xcb_connection_t* connection() const { return mConnection; }
+  const QVector<xcb_window_t>& clients() const { return mClients; }
+
+  xcb_window_t createClient(const QString& title, const QString& windowClass, quint32 color) {
+    const xcb_window_t window = xcb_generate_id(mConnection);
+    const int slot = mClients.count() % 64;
+    xcb_create_window(mConnection, XCB_COPY_FROM_PARENT, window, mScreen->root, 40 + (slot % 8) * 200,
+                      40 + (slot / 8) * 110, 320, 200, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT, mScreen->root_visual, 0,
+                      nullptr);
+
+    const QByteArray instance = windowClass.toUtf8().toLower();
+    const QByteArray wmClass = instance + '\0' + windowClass.toUtf8() + '\0';
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8,
+                        wmClass.size(), wmClass.constData());
+    setTitle(window, title);
+    setIcon(window, color);
+    setUrgent(window, false);
+
+    const quint32 type = atom("_NET_WM_WINDOW_TYPE_NORMAL");
+    setProperty(window, atom("_NET_WM_WINDOW_TYPE"), XCB_ATOM_ATOM, {type});
+    setProperty(window, atom("_NET_WM_DESKTOP"), XCB_ATOM_CARDINAL, {0});
+    setProperty(window, atom("WM_STATE"), atom("WM_STATE"), {1 /* NormalState */, XCB_NONE});
+
+    xcb_map_window(mConnection, window);
+    mClients.append(window);
+    return window;
+  }
+
+  void destroyClients() {
+    for (xcb_window_t window : std::as_const(mClients))
+      xcb_destroy_window(mConnection, window);
+    mClients.clear();
+    publishClientList();
+  }
+
+  // What the window manager does after managing windows
+  void publishClientList() {
+    const QVector<quint32> windows(mClients.cbegin(), mClients.cend());
+    setProperty(mScreen->root, atom("_NET_CLIENT_LIST"), XCB_ATOM_WINDOW, windows);
+    setProperty(mScreen->root, atom("_NET_CLIENT_LIST_STACKING"), XCB_ATOM_WINDOW, windows);
+    xcb_flush(mConnection);
+  }
+
+  void setTitle(xcb_window_t window, const QString& title) {
+    const QByteArray utf8 = title.toUtf8();
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, window, atom("_NET_WM_NAME"), atom("UTF8_STRING"), 8,
+                        utf8.size(), utf8.constData());
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                        utf8.size(), utf8.constData());
+  }
+
+  void setIcon(xcb_window_t window, quint32 color) {
+    QVector<quint32> icon(2 + kIconSize * kIconSize, 0xff000000 | color);
+    icon[0] = kIconSize;
+    icon[1] = kIconSize;
+    setProperty(window, atom("_NET_WM_ICON"), XCB_ATOM_CARDINAL, icon);
+  }
+
+  void setUrgent(xcb_window_t window, bool urgent) {
+    // flags, input, initial state, icon pixmap, icon window, icon x, icon y, icon mask, window group
+    QVector<quint32> hints(9, 0);
+    hints[0] = urgent ? kUrgencyHint : 0;
+    setProperty(window, XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, hints);
+
+    QVector<quint32> states;
+    if (urgent)
+      states.append(atom("_NET_WM_STATE_DEMANDS_ATTENTION"));
+    setProperty(window, atom("_NET_WM_STATE"), XCB_ATOM_ATOM, states);
+  }
+
+  // The panel's own top level window, once it is mapped
+  xcb_window_t findDock(int timeoutMs) {
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    const xcb_atom_t dockType = atom("_NET_WM_WINDOW_TYPE_DOCK");
+    while (Clock::now() < deadline) {
+      xcb_query_tree_reply_t* tree =
+          xcb_query_tree_reply(mConnection, xcb_query_tree(mConnection, mScreen->root), nullptr);
+      if (tree) {
+        const xcb_window_t* children = xcb_query_tree_children(tree);
+        const int count = xcb_query_tree_children_length(tree);
+        QVector<xcb_get_property_cookie_t> types;
+        QVector<xcb_get_window_attributes_cookie_t> attributes;
+        for (int i = 0; i < count; ++i) {
+          types.append(xcb_get_property(mConnection, false, children[i], atom("_NET_WM_WINDOW_TYPE"), XCB_ATOM_ATOM,
+                                        0, 16));
+          attributes.append(xcb_get_window_attributes(mConnection, children[i]));
+        }
+
+        xcb_window_t dock = XCB_NONE;
+        for (int i = 0; i < count; ++i) {
+          xcb_get_property_reply_t* type = xcb_get_property_reply(mConnection, types.at(i), nullptr);
+          xcb_get_window_attributes_reply_t* attr =
+              xcb_get_window_attributes_reply(mConnection, attributes.at(i), nullptr);
+          if (type && attr && attr->map_state == XCB_MAP_STATE_VIEWABLE) {
+            const auto* atoms = static_cast<const xcb_atom_t*>(xcb_get_property_value(type));
+            const int n = xcb_get_property_value_length(type) / int(sizeof(xcb_atom_t));
+            if (dock == XCB_NONE && std::find(atoms, atoms + n, dockType) != atoms + n)
+              dock = children[i];
+          }
+          free(type);
+          free(attr);
+        }
+        free(tree);
+        if (dock != XCB_NONE)
+          return dock;
+      }
+      QThread::msleep(50);
+    }
+    return XCB_NONE;
+  }
+
+ private:
+  xcb_atom_t atom(const char* name) const { return mAtoms.value(QByteArray(name), XCB_NONE); }
+
+  void internAtoms() {
+    static const char* const names[] = {"_NET_SUPPORTED",
+                                        "_NET_SUPPORTING_WM_CHECK",
+                                        "_NET_NUMBER_OF_DESKTOPS",
+                                        "_NET_CURRENT_DESKTOP",
+                                        "_NET_ACTIVE_WINDOW",
+                                        "_NET_CLIENT_LIST",
+                                        "_NET_CLIENT_LIST_STACKING",
+                                        "_NET_WM_NAME",
+                                        "_NET_WM_ICON",
+                                        "_NET_WM_DESKTOP",
+                                        "_NET_WM_STATE",
+                                        "_NET_WM_STATE_DEMANDS_ATTENTION",
+                                        "_NET_WM_WINDOW_TYPE",
+                                        "_NET_WM_WINDOW_TYPE_NORMAL",
+                                        "_NET_WM_WINDOW_TYPE_DOCK",
+                                        "UTF8_STRING",
+                                        "WM_STATE"};
+
+    // all requests first, one round trip
+    QVector<xcb_intern_atom_cookie_t> cookies;
+    for (const char* name : names)
+      cookies.append(xcb_intern_atom(mConnection, false, strlen(name), name));
+    for (int i = 0; i < cookies.count(); ++i) {
+      xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(mConnection, cookies.at(i), nullptr);
+      if (reply)
+        mAtoms.insert(QByteArray(names[i]), reply->atom);
+      free(reply);
+    }
+  }
+
+  void setupRoot() {
+    const xcb_window_t check = xcb_generate_id(mConnection);
+    xcb_create_window(mConnection, XCB_COPY_FROM_PARENT, check, mScreen->root, -1, -1, 1, 1, 0,
+                      XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT, 0, nullptr);
+    const QByteArray name("1g4-panel-benchmark");
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, check, atom("_NET_WM_NAME"), atom("UTF8_STRING"), 8,
+                        name.size(), name.constData());
+    setProperty(check, atom("_NET_SUPPORTING_WM_CHECK"), XCB_ATOM_WINDOW, {check});
+    setProperty(mScreen->root, atom("_NET_SUPPORTING_WM_CHECK"), XCB_ATOM_WINDOW, {check});
+
+    QVector<quint32> supported;
+    for (auto it = mAtoms.cbegin(); it != mAtoms.cend(); ++it) {
+      if (it.key().startsWith("_NET_") && it.key() != "_NET_SUPPORTED")
+        supported.append(it.value());
+    }
+    setProperty(mScreen->root, atom("_NET_SUPPORTED"), XCB_ATOM_ATOM, supported);
+    setProperty(mScreen->root, atom("_NET_NUMBER_OF_DESKTOPS"), XCB_ATOM_CARDINAL, {1});
+    setProperty(mScreen->root, atom("_NET_CURRENT_DESKTOP"), XCB_ATOM_CARDINAL, {0});
+    setProperty(mScreen->root, atom("_NET_ACTIVE_WINDOW"), XCB_ATOM_WINDOW, {XCB_NONE});
+    publishClientList();
+  }
+
+  void setProperty(xcb_window_t window, xcb_atom_t property, xcb_atom_t type, const QVector<quint32>& values) {
+    xcb_change_property(mConnection, XCB_PROP_MODE_REPLACE, window, property, type, 32, values.count(),
+                        values.constData());
+  }
+
+  QProcess mXvfb;
+  int mDisplay = -1;
+  xcb_connection_t* mConnection = nullptr;
+  xcb_screen_t* mScreen = nullptr;
+  QVector<xcb_window_t> mClients;
+  QHash<QByteArray, xcb_atom_t> mAtoms;
+};
+
+/*!
+ * \brief Reports repaints of one window through the DAMAGE extension.
+ */
+class DamageWatch {
+ public:
+  DamageWatch(xcb_connection_t* connection, xcb_window_t window) : mConnection(connection) {
+    const xcb_query_extension_reply_t* extension = xcb_get_extension_data(mConnection, &xcb_damage_id);
+    if (!extension || !extension->present)
+      return;
+    mNotifyEvent = extension->first_event + XCB_DAMAGE_NOTIFY;
+
+    free(xcb_damage_query_version_reply(mConnection, xcb_damage_query_version(mConnection, 1, 1), nullptr));
+    mDamage = xcb_generate_id(mConnection);
+    xcb_damage_create(mConnection, mDamage, window, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+    xcb_flush(mConnection);
+  }
+
+  ~DamageWatch() {
+    if (mDamage != XCB_NONE) {
+      xcb_damage_destroy(mConnection, mDamage);
+      xcb_flush(mConnection);
+    }
+  }
+
+  bool isValid() const { return mDamage != XCB_NONE; }
+
+  // Waits for the next repaint, false if none happened before the timeout
+  bool wait(int timeoutMs, Clock::time_point* when) {
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+      while (xcb_generic_event_t* event = xcb_poll_for_event(mConnection)) {
+        const bool damaged = (event->response_type & ~0x80) == mNotifyEvent;
+        free(event);
+        if (damaged) {
+          *when = Clock::now();
+          // a non empty level damage reports again only once it was emptied
+          xcb_damage_subtract(mConnection, mDamage, XCB_NONE, XCB_NONE);
+          xcb_flush(mConnection);
+          return true;
+        }
+      }
+
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+      if (left <= 0 || xcb_connection_has_error(mConnection))
+        return false;
+      pollfd fd{xcb_get_file_descriptor(mConnection), POLLIN, 0};
+      poll(&fd, 1, int(left));
+    }
+  }
+
+  // Waits until nothing is repainted for quietMs, returns the time of the last repaint or since if none
+  Clock::time_point settle(Clock::time_point since, int quietMs, int timeoutMs) {
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    Clock::time_point last = since;
+    Clock::time_point when;
+    while (Clock::now() < deadline && wait(quietMs, &when))
+      last = when;
+    return last;
+  }
+
+ private:
+  xcb_connection_t* mConnection;
+  xcb_damage_damage_t mDamage = XCB_NONE;
+  quint8 mNotifyEvent = 0;
+};
+
+qint64 residentKiB(qint64 pid) {
+  QFile status(QStringLiteral("/proc/%1/status").arg(pid));
+  if (!status.open(QIODevice::ReadOnly))
+    return -1;
+  while (!status.atEnd()) {
+    const QByteArray line = status.readLine();
+    if (line.startsWith("VmRSS:"))
+      return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+  }
+  return -1;
+}
+
+double percentile(QVector<double> values, double p) {
+  if (values.isEmpty())
+    return 0;
+  std::sort(values.begin(), values.end());
+  return values.at(qMin(values.count() - 1, int(p * values.count())));
+}
+
+struct Options {
+  QString panel;
+  QString xvfb;
+  QVector<int> counts;
+  int events = 200;
+  int classes = 20;
+  int quiet = 500;
+  bool grouping = false;
+};
+
+bool writePanelConfig(const QString& fileName, const Options& options) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  QTextStream out(&file);
+  out << "panels=panel1\n\n"
+      << "[panel1]\n"
+      << "plugins=taskbar\n"
+      << "position=Bottom\n"
+      << "panelSize=32\n"
+      << "width=100\n"
+      << "width-percent=true\n"
+      << "animation-duration=0\n"
+      << "hidable=false\n\n"
+      << "[taskbar]\n"
+      << "type=taskbar\n"
+      << "buttonStyle=IconText\n"
+      << "groupingEnabled=" << (options.grouping ? "true" : "false") << "\n";
+  return true;
+}
+
+class PanelProcess {
+ public:
+  ~PanelProcess() { stop(); }
+
+  bool start(const Options& options, const QString& display, const QString& configDir) {
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("DISPLAY"), display);
+    env.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("xcb"));
+    env.insert(QStringLiteral("XDG_CONFIG_HOME"), configDir);
+    mProcess.setProcessEnvironment(env);
+    mProcess.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    const QString config = QDir(configDir).absoluteFilePath(QStringLiteral("panel.conf"));
+    mProcess.start(options.panel, {QStringLiteral("-c"), config});
+    return mProcess.waitForStarted();
+  }
+
+  void stop() {
+    if (mProcess.state() == QProcess::NotRunning)
+      return;
+    mProcess.terminate();
+    if (!mProcess.waitForFinished(5000))
+      mProcess.kill();
+    mProcess.waitForFinished();
+  }
+
+  qint64 pid() const { return mProcess.processId(); }
+
+ private:
+  QProcess mProcess;
+};
+
+bool runRound(FakeDesktop& desktop, const Options& options, const QString& configDir, int count, QTextStream& out) {
+  PanelProcess panel;
+  if (!panel.start(options, desktop.display(), configDir)) {
+    qWarning("Cannot start %s", qPrintable(options.panel));
+    return false;
+  }
+
+  const xcb_window_t dock = desktop.findDock(15000);
+  if (dock == XCB_NONE) {
+    qWarning("The panel did not show up");
+    return false;
+  }
+  DamageWatch damage(desktop.connection(), dock);
+  if (!damage.isValid()) {
+    qWarning("The X server has no DAMAGE extension");
+    return false;
+  }
+  damage.settle(Clock::now(), options.quiet, 15000);
+  const qint64 idleRss = residentKiB(panel.pid());
+
+  // populate
+  const auto populateStart = Clock::now();
+  for (int i = 0; i < count; ++i) {
+    desktop.createClient(QStringLiteral("Synthetic window %1").arg(i),
+                         QStringLiteral("Benchmark%1").arg(i % qMax(1, options.classes)), quint32(i * 2654435761u));
+  }
+  desktop.publishClientList();
+  const auto populated = damage.settle(populateStart, options.quiet, 120000);
+  const qint64 rss = residentKiB(panel.pid());
+
+  // per event latency, title, icon and urgency changes in turn
+  QVector<double> latencies;
+  int missed = 0;
+  QSet<xcb_window_t> urgent;  // flipping the real state, clearing a calm window repaints nothing
+  const QVector<xcb_window_t>& clients = desktop.clients();
+  for (int i = 0; i < options.events && !clients.isEmpty(); ++i) {
+    const xcb_window_t window = clients.at((i * 7919) % clients.count());
+    switch (i % 3) {
+      case 0:
+        desktop.setTitle(window, QStringLiteral("Synthetic window, change %1").arg(i));
+        break;
+      case 1:
+        desktop.setIcon(window, quint32(i * 40503u));
+        break;
+      default:
+        if (urgent.remove(window)) {
+          desktop.setUrgent(window, false);
+        }
+        else {
+          urgent.insert(window);
+          desktop.setUrgent(window, true);
+        }
+        break;
+    }
+    xcb_flush(desktop.connection());
+
+    const auto changed = Clock::now();
+    Clock::time_point repainted = changed;
+    if (damage.wait(2000, &repainted))
+      latencies.append(msecsBetween(changed, repainted));
+    else
+      ++missed;
+    // let follow up repaints pass so they are not taken for the next change's
+    damage.settle(repainted, 50, 2000);
+  }
+
+  out << qSetFieldWidth(8) << count << qSetFieldWidth(13)
+      << QString::number(msecsBetween(populateStart, populated), 'f', 1) << qSetFieldWidth(12)
+      << QString::number(percentile(latencies, 0.5), 'f', 2) << qSetFieldWidth(12)
+      << QString::number(percentile(latencies, 0.95), 'f', 2) << qSetFieldWidth(8) << missed << qSetFieldWidth(12)
+      << rss << qSetFieldWidth(12) << (rss >= 0 && idleRss >= 0 ? rss - idleRss : -1) << qSetFieldWidth(0) << "\n";
+  out.flush();
+
+  desktop.destroyClients();
+  panel.stop();
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("1g4-panel-benchmark"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral("Measures how the panel's taskbar scales with the window count"));
+  parser.addHelpOption();
+  QCommandLineOption panelOption(QStringLiteral("panel"), QStringLiteral("Panel binary."), QStringLiteral("path"),
+                                 QStringLiteral(ONEG4_PANEL_BINARY));
+  QCommandLineOption xvfbOption(QStringLiteral("xvfb"), QStringLiteral("Xvfb binary."), QStringLiteral("path"),
+                                QStringLiteral("Xvfb"));
+  QCommandLineOption countsOption(QStringLiteral("counts"), QStringLiteral("Comma separated window counts."),
+                                  QStringLiteral("list"), QStringLiteral("10,100,500,1000"));
+  QCommandLineOption eventsOption(QStringLiteral("events"), QStringLiteral("Property changes timed per round."),
+                                  QStringLiteral("n"), QStringLiteral("200"));
+  QCommandLineOption classesOption(QStringLiteral("classes"), QStringLiteral("Distinct window classes."),
+                                   QStringLiteral("n"), QStringLiteral("20"));
+  QCommandLineOption quietOption(QStringLiteral("quiet"),
+                                 QStringLiteral("Milliseconds without repaint after which the panel is settled."),
+                                 QStringLiteral("ms"), QStringLiteral("500"));
+  QCommandLineOption groupingOption(QStringLiteral("grouping"), QStringLiteral("Group windows by class."));
+  parser.addOptions({panelOption, xvfbOption, countsOption, eventsOption, classesOption, quietOption, groupingOption});
+  parser.process(app);
+
+  Options options;
+  options.panel = parser.value(panelOption);
+  options.xvfb = parser.value(xvfbOption);
+  options.events = parser.value(eventsOption).toInt();
+  options.classes = parser.value(classesOption).toInt();
+  options.quiet = qMax(50, parser.value(quietOption).toInt());
+  options.grouping = parser.isSet(groupingOption);
+  const auto counts = parser.value(countsOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+  for (const QString& count : counts) {
+    if (count.toInt() > 0)
+      options.counts.append(count.toInt());
+  }
+
+  QTemporaryDir configDir;
+  if (!configDir.isValid() || !writePanelConfig(configDir.filePath(QStringLiteral("panel.conf")), options)) {
+    qWarning("Cannot write the panel configuration");
+    return 1;
+  }
+
+  FakeDesktop desktop;
+  if (!desktop.start(options.xvfb))
+    return 1;
+
+  QTextStream out(stdout);
+  out << qSetFieldWidth(8) << "windows" << qSetFieldWidth(13) << "populate ms" << qSetFieldWidth(12) << "p50 ms"
+      << qSetFieldWidth(12) << "p95 ms" << qSetFieldWidth(8) << "missed" << qSetFieldWidth(12) << "RSS KiB"
+      << qSetFieldWidth(12) << "+RSS KiB" << qSetFieldWidth(0) << "\n";
+
+  for (int count : std::as_const(options.counts)) {
+    if (!runRound(desktop, options, configDir.path(), count, out))
+      return 1;
+  }
+  return 0;
+}
@@ -4,7 +4,11 @@
 
 #include "ioneg4abstractwmiface.h"
 
-IOneG4AbstractWMInterface::IOneG4AbstractWMInterface(QObject* parent) : QObject(parent) {}
+IOneG4AbstractWMInterface::IOneG4AbstractWMInterface(QObject* parent) : QObject(parent), mFlushQueued(false) {}
+
+bool IOneG4AbstractWMInterface::requestApplicationIcon(WId, int) {
+  return false;
+}
 
 void IOneG4AbstractWMInterface::moveApplicationToPrevNextDesktop(WId windowId, bool next) {
   int count = getWorkspacesCount();
@@ -26,4 +30,97 @@ int IOneG4AbstractWMInterface::onAllWorkspacesEnum() const {
   // Virtual destops have 1-based indexes.
   // NOTE: The real value of this enum may be negative (as in X11).
   return 0;
-}
\ No newline at end of file
+}
+
+void IOneG4AbstractWMInterface::refreshIconGeometries(const QHash<WId, QRect>& geometries) {
+  for (auto it = geometries.cbegin(); it != geometries.cend(); ++it)
+    refreshIconGeometry(it.key(), it.value());
+}
+
+void IOneG4AbstractWMInterface::watchArea(const QRect& area) {
+  for (WatchedArea& watched : mWatchedAreas) {
+    if (watched.area == area) {
+      ++watched.refs;
+      return;
+    }
+  }
+
+  if (mWatchedAreas.isEmpty()) {
+    // anything that can change what overlaps an area comes through one of these
+    connect(this, &IOneG4AbstractWMInterface::windowAdded, this, &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    connect(this, &IOneG4AbstractWMInterface::windowRemoved, this, &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    connect(this, &IOneG4AbstractWMInterface::windowPropertiesChanged, this,
+            &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    connect(this, &IOneG4AbstractWMInterface::windowScreenChanged, this,
+            &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    connect(this, &IOneG4AbstractWMInterface::currentWorkspaceChanged, this,
+            &IOneG4AbstractWMInterface::refreshWatchedAreas);
+  }
+
+  WatchedArea watched;
+  watched.area = area;
+  watched.refs = 1;
+  watched.overlapped = isAreaOverlapped(area);
+  mWatchedAreas.append(watched);
+}
+
+void IOneG4AbstractWMInterface::unwatchArea(const QRect& area) {
+  for (int i = 0; i < mWatchedAreas.count(); ++i) {
+    if (mWatchedAreas.at(i).area == area) {
+      if (--mWatchedAreas[i].refs == 0)
+        mWatchedAreas.remove(i);
+      break;
+    }
+  }
+
+  if (mWatchedAreas.isEmpty()) {
+    disconnect(this, &IOneG4AbstractWMInterface::windowAdded, this, &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    disconnect(this, &IOneG4AbstractWMInterface::windowRemoved, this,
+               &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    disconnect(this, &IOneG4AbstractWMInterface::windowPropertiesChanged, this,
+               &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    disconnect(this, &IOneG4AbstractWMInterface::windowScreenChanged, this,
+               &IOneG4AbstractWMInterface::refreshWatchedAreas);
+    disconnect(this, &IOneG4AbstractWMInterface::currentWorkspaceChanged, this,
+               &IOneG4AbstractWMInterface::refreshWatchedAreas);
+  }
+}
+
+void IOneG4AbstractWMInterface::refreshWatchedAreas() {
+  // receivers may watch or unwatch areas while handling the signal
+  for (int i = 0; i < mWatchedAreas.count(); ++i) {
+    const QRect area = mWatchedAreas.at(i).area;
+    const bool overlapped = isAreaOverlapped(area);
+    if (overlapped == mWatchedAreas.at(i).overlapped)
+      continue;
+
+    mWatchedAreas[i].overlapped = overlapped;
+    emit areaOverlapChanged(area, overlapped);
+  }
+}
+
+void IOneG4AbstractWMInterface::queueWindowPropertiesChange(WId windowId, int props) {
+  if (props == 0)
+    return;
+
+  mPendingProperties[windowId] |= props;
+
+  if (!mFlushQueued) {
+    mFlushQueued = true;
+    QMetaObject::invokeMethod(this, &IOneG4AbstractWMInterface::flushWindowPropertiesChanges, Qt::QueuedConnection);
+  }
+}
+
+void IOneG4AbstractWMInterface::discardWindowPropertiesChanges(WId windowId) {
+  mPendingProperties.remove(windowId);
+}
+
+void IOneG4AbstractWMInterface::flushWindowPropertiesChanges() {
+  mFlushQueued = false;
+
+  // consumers may trigger new changes while handling these, they go to the next turn
+  QHash<WId, int> pending;
+  pending.swap(mPendingProperties);
+  for (auto it = pending.cbegin(); it != pending.cend(); ++it)
+    emit windowPropertiesChanged(it.key(), it.value());
+}
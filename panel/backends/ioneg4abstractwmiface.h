@@ -5,12 +5,15 @@
 #ifndef IONEG4_ABSTRACT_WM_INTERFACE_H
 #define IONEG4_ABSTRACT_WM_INTERFACE_H
 
+#include <QHash>
+#include <QIcon>
 #include <QObject>
+#include <QRect>
+#include <QVector>
 
 #include "../oneg4panelglobals.h"
 #include "oneg4taskbartypes.h"
 
-class QIcon;
 class QScreen;
 
 class ONEG4_PANEL_API IOneG4AbstractWMInterface : public QObject {
@@ -32,6 +35,9 @@ class ONEG4_PANEL_API IOneG4AbstractWMInterface : public QObject {
   virtual bool applicationDemandsAttention(WId windowId) const = 0;
 
   virtual QIcon getApplicationIcon(WId windowId, int fallbackDevicePixels) const = 0;
+  // Asks for the icon to be delivered later through windowIconReady(), without blocking.
+  // Returns false if the backend can't do that, use getApplicationIcon() then.
+  virtual bool requestApplicationIcon(WId windowId, int devicePixels);
 
   virtual QString getWindowClass(WId windowId) const = 0;
 
@@ -73,9 +79,16 @@ class ONEG4_PANEL_API IOneG4AbstractWMInterface : public QObject {
   virtual void resizeApplication(WId windowId) = 0;
 
   virtual void refreshIconGeometry(WId windowId, const QRect& geom) = 0;
+  // All icon geometries of one layout pass, the default implementation calls refreshIconGeometry() for each
+  virtual void refreshIconGeometries(const QHash<WId, QRect>& geometries);
 
   // Panel internal
   virtual bool isAreaOverlapped(const QRect& area) const = 0;
+  // Watched areas get areaOverlapChanged() on every overlapped <-> clear transition.
+  // Calls are reference counted. The default implementation asks isAreaOverlapped() again
+  // after every window or workspace signal, backends with a spatial index do better.
+  virtual void watchArea(const QRect& area);
+  virtual void unwatchArea(const QRect& area);
 
   // Show Destop TODO: split in multiple interfeces, this is becoming big
   // NOTE: KWindowSystem already has these functions
@@ -89,7 +102,14 @@ class ONEG4_PANEL_API IOneG4AbstractWMInterface : public QObject {
   // Windows
   void windowAdded(WId windowId);
   void windowRemoved(WId windowId);
-  void windowPropertyChanged(WId windowId, int prop);
+  // props is a mask of windowPropertyMask() bits, changes are merged per event loop turn
+  void windowPropertiesChanged(WId windowId, int props);
+  // The screen isWindowOnScreen() is true for changed, not emitted for moves within a screen
+  void windowScreenChanged(WId windowId);
+  // Answer to requestApplicationIcon(), a null icon means the window has no usable icon data
+  void windowIconReady(WId windowId, int devicePixels, const QIcon& icon);
+  // The window is gone, its requestApplicationIcon() calls will not be answered
+  void windowIconRequestsCancelled(WId windowId);
 
   // Workspaces
   void workspacesCountChanged();
@@ -98,6 +118,34 @@ class ONEG4_PANEL_API IOneG4AbstractWMInterface : public QObject {
 
   // TODO: needed?
   void activeWindowChanged(WId windowId);
+
+  // Panel internal
+  void areaOverlapChanged(const QRect& area, bool overlapped);
+
+  // Actions the window manager applies asynchronously report here once the window reached the
+  // requested state, applied is false if the backend stopped waiting for it
+  void windowActionFinished(WId windowId, OneG4TaskBarBackendAction action, bool applied);
+
+ protected:
+  // Backends report property changes through these so that bursts (e.g. a title updated many
+  // times per second) reach the consumers as a single windowPropertiesChanged()
+  void queueWindowPropertiesChange(WId windowId, int props);
+  void discardWindowPropertiesChanges(WId windowId);
+  // Re-evaluates the areas watched through the default watchArea()
+  void refreshWatchedAreas();
+
+ private:
+  void flushWindowPropertiesChanges();
+
+  QHash<WId, int> mPendingProperties;
+  bool mFlushQueued;
+
+  struct WatchedArea {
+    QRect area;
+    int refs = 0;
+    bool overlapped = false;
+  };
+  QVector<WatchedArea> mWatchedAreas;
 };
 
 class ONEG4_PANEL_API IOneG4WMBackendLibrary {
@@ -79,7 +79,10 @@ class OneG4DummyWMBackend : public IOneG4AbstractWMInterface {
   // Windows
   void windowAdded(WId windowId);
   void windowRemoved(WId windowId);
-  void windowPropertyChanged(WId windowId, int prop);
+  void windowPropertiesChanged(WId windowId, int props);
+  void windowScreenChanged(WId windowId);
+  void windowIconReady(WId windowId, int devicePixels, const QIcon& icon);
+  void windowIconRequestsCancelled(WId windowId);
 
   // Workspaces
   void workspacesCountChanged();
@@ -88,6 +91,11 @@ class OneG4DummyWMBackend : public IOneG4AbstractWMInterface {
 
   // TODO: needed?
   void activeWindowChanged(WId windowId);
+
+  // Panel internal
+  void areaOverlapChanged(const QRect& area, bool overlapped);
+
+  void windowActionFinished(WId windowId, OneG4TaskBarBackendAction action, bool applied);
 };
 
 #endif  // ONEG4_DUMMY_WM_BACKEND_H
\ No newline at end of file
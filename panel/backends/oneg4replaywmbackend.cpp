@@ -0,0 +1,325 @@
+/* panel/backends/oneg4replaywmbackend.cpp
+ * Window manager backend interfaces
+ */
+
+#include "oneg4replaywmbackend.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QIcon>
+#include <QScreen>
+
+#include <algorithm>
+
+OneG4ReplayWMBackend::OneG4ReplayWMBackend(const QString& fileName, qreal speed, QObject* parent)
+    : IOneG4AbstractWMInterface(parent),
+      mSpeed(qMax<qreal>(0, speed)),
+      mValid(false),
+      mNextTimestamp(-1),
+      mActiveWindow(0),
+      mCurrentWorkspace(0),
+      mWorkspacesCount(1),
+      mAllWorkspaces(0) {
+  mTimer.setSingleShot(true);
+  connect(&mTimer, &QTimer::timeout, this, &OneG4ReplayWMBackend::playDue);
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Cannot replay window manager events from" << fileName << ":" << file.errorString();
+    return;
+  }
+
+  // traces are small enough to be kept in memory, that keeps disk I/O out of the replay
+  mTrace.setData(file.readAll());
+  mTrace.open(QIODevice::ReadOnly);
+  mStream.setDevice(&mTrace);
+  mStream.setVersion(QDataStream::Qt_6_0);
+
+  mValid = readHeader();
+  if (!mValid)
+    qWarning() << "Invalid window manager trace" << fileName;
+}
+
+bool OneG4ReplayWMBackend::readHeader() {
+  quint32 magic = 0;
+  quint16 version = 0;
+  mStream >> magic >> version;
+  if (magic != kOneG4WMTraceMagic || version < 1 || version > kOneG4WMTraceVersion)
+    return false;
+
+  qint32 allWorkspaces, workspacesCount, currentWorkspace, windowCount;
+  quint64 activeWindow;
+  mStream >> allWorkspaces >> workspacesCount >> currentWorkspace >> activeWindow >> windowCount;
+  mAllWorkspaces = allWorkspaces;
+  mWorkspacesCount = workspacesCount;
+  mCurrentWorkspace = currentWorkspace;
+  mActiveWindow = WId(activeWindow);
+
+  for (int i = 0; i < windowCount && mStream.status() == QDataStream::Ok; ++i) {
+    quint64 windowId;
+    OneG4WMTraceWindow record;
+    mStream >> windowId >> record;
+    mWindows.append(WId(windowId));
+    mRecords.insert(WId(windowId), record);
+  }
+
+  return mStream.status() == QDataStream::Ok && readTimestamp();
+}
+
+bool OneG4ReplayWMBackend::readTimestamp() {
+  if (mStream.atEnd()) {
+    mNextTimestamp = -1;
+    return true;
+  }
+
+  qint64 timestamp;
+  mStream >> timestamp;
+  mNextTimestamp = timestamp;
+  return mStream.status() == QDataStream::Ok;
+}
+
+void OneG4ReplayWMBackend::start() {
+  if (!mValid || mClock.isValid())
+    return;
+
+  mClock.start();
+  playDue();
+}
+
+void OneG4ReplayWMBackend::playDue() {
+  // with no speed everything recorded in the same millisecond forms one batch
+  const qint64 now = mSpeed > 0 ? qint64(mClock.elapsed() * mSpeed) : mNextTimestamp;
+  while (mNextTimestamp >= 0 && mNextTimestamp <= now) {
+    if (!playRecord()) {
+      qWarning() << "Window manager trace is truncated, replay stopped";
+      mNextTimestamp = -1;
+    }
+  }
+
+  if (mNextTimestamp < 0) {
+    qDebug() << "Window manager trace replayed in" << mClock.elapsed() << "ms";
+    emit finished();
+    return;
+  }
+
+  mTimer.start(mSpeed > 0 ? int((mNextTimestamp - now) / mSpeed) : 0);
+}
+
+bool OneG4ReplayWMBackend::playRecord() {
+  quint8 event;
+  quint64 windowId;
+  qint32 value;
+  OneG4WMTraceWindow record;
+  QRect area;
+  bool overlapped;
+
+  mStream >> event;
+  switch (OneG4WMTraceEvent(event)) {
+    case OneG4WMTraceEvent::WindowAdded:
+      mStream >> windowId >> record;
+      mRecords.insert(WId(windowId), record);
+      if (mWindows.append(WId(windowId)))
+        emit windowAdded(WId(windowId));
+      break;
+
+    case OneG4WMTraceEvent::WindowRemoved:
+      mStream >> windowId;
+      discardWindowPropertiesChanges(WId(windowId));
+      mRecords.remove(WId(windowId));
+      if (mWindows.remove(WId(windowId)))
+        emit windowRemoved(WId(windowId));
+      break;
+
+    case OneG4WMTraceEvent::WindowChanged:
+      mStream >> windowId >> value >> record;
+      if (mWindows.contains(WId(windowId))) {
+        const bool screenChanged = mRecords.value(WId(windowId)).screens != record.screens;
+        mRecords.insert(WId(windowId), record);
+        // goes through the same per turn coalescing as a live backend
+        queueWindowPropertiesChange(WId(windowId), value);
+        if (screenChanged)
+          emit windowScreenChanged(WId(windowId));
+      }
+      break;
+
+    case OneG4WMTraceEvent::ActiveWindowChanged:
+      mStream >> windowId;
+      mActiveWindow = WId(windowId);
+      emit activeWindowChanged(mActiveWindow);
+      break;
+
+    case OneG4WMTraceEvent::CurrentWorkspaceChanged:
+      mStream >> value;
+      mCurrentWorkspace = value;
+      emit currentWorkspaceChanged(mCurrentWorkspace);
+      break;
+
+    case OneG4WMTraceEvent::WorkspacesCountChanged:
+      mStream >> value;
+      mWorkspacesCount = value;
+      emit workspacesCountChanged();
+      break;
+
+    case OneG4WMTraceEvent::AreaOverlapChanged: {
+      mStream >> area >> overlapped;
+      auto known = std::find_if(mAreaOverlaps.begin(), mAreaOverlaps.end(),
+                                [&area](const QPair<QRect, bool>& entry) { return entry.first == area; });
+      if (mAreaOverlaps.end() != known)
+        known->second = overlapped;
+      else
+        mAreaOverlaps.append({area, overlapped});
+      // the areas the panel watches here are told through the default watchArea()
+      refreshWatchedAreas();
+      break;
+    }
+
+    default:
+      return false;
+  }
+
+  return mStream.status() == QDataStream::Ok && readTimestamp();
+}
+
+/************************************************
+ *   Windows function
+ ************************************************/
+bool OneG4ReplayWMBackend::supportsAction(WId, OneG4TaskBarBackendAction) const {
+  return false;
+}
+
+bool OneG4ReplayWMBackend::reloadWindows() {
+  // same contract as the live backends: every window is announced again
+  const auto windows = mWindows.toVector();
+  for (WId windowId : windows)
+    emit windowAdded(windowId);
+
+  emit reloaded();
+  return true;
+}
+
+QVector<WId> OneG4ReplayWMBackend::getCurrentWindows() const {
+  return mWindows.toVector();
+}
+
+QString OneG4ReplayWMBackend::getWindowTitle(WId windowId) const {
+  return mRecords.value(windowId).title;
+}
+
+bool OneG4ReplayWMBackend::applicationDemandsAttention(WId windowId) const {
+  return mRecords.value(windowId).demandsAttention;
+}
+
+QIcon OneG4ReplayWMBackend::getApplicationIcon(WId, int) const {
+  // icons are not part of the trace, the taskbar falls back to the theme
+  return QIcon();
+}
+
+QString OneG4ReplayWMBackend::getWindowClass(WId windowId) const {
+  return mRecords.value(windowId).windowClass;
+}
+
+OneG4TaskBarWindowLayer OneG4ReplayWMBackend::getWindowLayer(WId windowId) const {
+  return mRecords.value(windowId).layer;
+}
+
+bool OneG4ReplayWMBackend::setWindowLayer(WId, OneG4TaskBarWindowLayer) {
+  return false;
+}
+
+OneG4TaskBarWindowState OneG4ReplayWMBackend::getWindowState(WId windowId) const {
+  return mRecords.value(windowId).state;
+}
+
+bool OneG4ReplayWMBackend::setWindowState(WId, OneG4TaskBarWindowState, bool) {
+  return false;
+}
+
+bool OneG4ReplayWMBackend::isWindowActive(WId windowId) const {
+  return windowId != 0 && windowId == mActiveWindow;
+}
+
+bool OneG4ReplayWMBackend::raiseWindow(WId, bool) {
+  return false;
+}
+
+bool OneG4ReplayWMBackend::closeWindow(WId) {
+  return false;
+}
+
+WId OneG4ReplayWMBackend::getActiveWindow() const {
+  return mActiveWindow;
+}
+
+/************************************************
+ *   Workspaces
+ ************************************************/
+int OneG4ReplayWMBackend::getWorkspacesCount(QScreen*) const {
+  return mWorkspacesCount;
+}
+
+QString OneG4ReplayWMBackend::getWorkspaceName(int, QString) const {
+  return QString();
+}
+
+int OneG4ReplayWMBackend::getCurrentWorkspace(QScreen*) const {
+  return mCurrentWorkspace;
+}
+
+bool OneG4ReplayWMBackend::setCurrentWorkspace(int, QScreen*) {
+  return false;
+}
+
+int OneG4ReplayWMBackend::getWindowWorkspace(WId windowId) const {
+  return mRecords.value(windowId).workspace;
+}
+
+bool OneG4ReplayWMBackend::setWindowOnWorkspace(WId, int) {
+  return false;
+}
+
+void OneG4ReplayWMBackend::moveApplicationToPrevNextMonitor(WId, bool, bool) {
+  // No-op
+}
+
+int OneG4ReplayWMBackend::onAllWorkspacesEnum() const {
+  return mAllWorkspaces;
+}
+
+bool OneG4ReplayWMBackend::isWindowOnScreen(QScreen* screen, WId windowId) const {
+  return screen && mRecords.value(windowId).screens.contains(screen->name());
+}
+
+bool OneG4ReplayWMBackend::setDesktopLayout(Qt::Orientation, int, int, bool) {
+  return false;
+}
+
+/************************************************
+ *   X11 Specific
+ ************************************************/
+void OneG4ReplayWMBackend::moveApplication(WId) {
+  // No-op
+}
+
+void OneG4ReplayWMBackend::resizeApplication(WId) {
+  // No-op
+}
+
+void OneG4ReplayWMBackend::refreshIconGeometry(WId, QRect const&) {
+  // No-op
+}
+
+bool OneG4ReplayWMBackend::isAreaOverlapped(const QRect& area) const {
+  for (const auto& entry : mAreaOverlaps) {
+    if (entry.first == area)
+      return entry.second;
+  }
+  return false;
+}
+
+bool OneG4ReplayWMBackend::isShowingDesktop() const {
+  return false;
+}
+
+bool OneG4ReplayWMBackend::showDesktop(bool) {
+  return false;
+}
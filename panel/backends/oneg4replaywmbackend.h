@@ -0,0 +1,122 @@
+/* panel/backends/oneg4replaywmbackend.h
+ * Window manager backend interfaces
+ */
+
+#ifndef ONEG4_REPLAY_WM_BACKEND_H
+#define ONEG4_REPLAY_WM_BACKEND_H
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "ioneg4abstractwmiface.h"
+#include "oneg4windowlist.h"
+#include "oneg4wmtrace.h"
+
+/*!
+ * \brief Backend feeding a trace written by OneG4WMRecorder back to the panel.
+ *
+ * The getters answer from the state rebuilt out of the trace, actions are ignored so that
+ * the replay stays deterministic. Records are played at the recorded pace scaled by speed,
+ * a speed of 0 plays them back to back, one recorded millisecond per event loop turn.
+ */
+class OneG4ReplayWMBackend : public IOneG4AbstractWMInterface {
+  Q_OBJECT
+
+ public:
+  explicit OneG4ReplayWMBackend(const QString& fileName, qreal speed = 1.0, QObject* parent = nullptr);
+
+  // false if the trace could not be read, the backend is empty then
+  bool isValid() const { return mValid; }
+
+  void start();
+
+  // Backend
+  bool supportsAction(WId windowId, OneG4TaskBarBackendAction action) const override;
+
+  // Windows
+  bool reloadWindows() override;
+
+  QVector<WId> getCurrentWindows() const override;
+
+  QString getWindowTitle(WId windowId) const override;
+
+  bool applicationDemandsAttention(WId windowId) const override;
+
+  QIcon getApplicationIcon(WId windowId, int fallbackDevicePixels) const override;
+
+  QString getWindowClass(WId windowId) const override;
+
+  OneG4TaskBarWindowLayer getWindowLayer(WId windowId) const override;
+  bool setWindowLayer(WId windowId, OneG4TaskBarWindowLayer layer) override;
+
+  OneG4TaskBarWindowState getWindowState(WId windowId) const override;
+  bool setWindowState(WId windowId, OneG4TaskBarWindowState state, bool set = true) override;
+
+  bool isWindowActive(WId windowId) const override;
+  bool raiseWindow(WId windowId, bool onCurrentWorkSpace) override;
+
+  bool closeWindow(WId windowId) override;
+
+  WId getActiveWindow() const override;
+
+  // Workspaces
+  int getWorkspacesCount(QScreen* screen = nullptr) const override;
+  QString getWorkspaceName(int idx, QString outputName = QString()) const override;
+
+  int getCurrentWorkspace(QScreen* screen = nullptr) const override;
+  bool setCurrentWorkspace(int idx, QScreen* screen = nullptr) override;
+
+  int getWindowWorkspace(WId windowId) const override;
+  bool setWindowOnWorkspace(WId windowId, int idx) override;
+
+  void moveApplicationToPrevNextMonitor(WId windowId, bool next, bool raiseOnCurrentDesktop) override;
+
+  int onAllWorkspacesEnum() const override;
+
+  bool isWindowOnScreen(QScreen* screen, WId windowId) const override;
+
+  bool setDesktopLayout(Qt::Orientation orientation, int rows, int columns, bool rightToLeft) override;
+
+  // X11 Specific
+  void moveApplication(WId windowId) override;
+  void resizeApplication(WId windowId) override;
+
+  void refreshIconGeometry(WId windowId, const QRect& geom) override;
+
+  // Panel internal
+  bool isAreaOverlapped(const QRect& area) const override;
+
+  // Show Destop
+  bool isShowingDesktop() const override;
+  bool showDesktop(bool value) override;
+
+ signals:
+  void finished();
+
+ private:
+  bool readHeader();
+  bool playRecord();
+  bool readTimestamp();
+  void playDue();
+
+  QBuffer mTrace;
+  QDataStream mStream;
+  qreal mSpeed;
+  bool mValid;
+
+  QTimer mTimer;
+  QElapsedTimer mClock;
+  qint64 mNextTimestamp;  //!< timestamp of the next record, -1 at the end of the trace
+
+  OneG4WindowList mWindows;
+  QHash<WId, OneG4WMTraceWindow> mRecords;
+  WId mActiveWindow;
+  int mCurrentWorkspace;
+  int mWorkspacesCount;
+  int mAllWorkspaces;
+  QVector<QPair<QRect, bool>> mAreaOverlaps;  //!< last recorded verdict per area
+};
+
+#endif  // ONEG4_REPLAY_WM_BACKEND_H
@@ -21,11 +21,17 @@ enum class OneG4TaskBarBackendAction {
   DesktopSwitch,
   MoveToDesktop,
   MoveToLayer,
-  MoveToOutput
+  MoveToOutput,
+  Activate
 };
 
 enum class OneG4TaskBarWindowProperty { Title = 0, Icon, State, Geometry, Urgency, WindowClass, Workspace };
 
+// Bit of a property in the masks delivered by IOneG4AbstractWMInterface::windowPropertiesChanged()
+constexpr int windowPropertyMask(OneG4TaskBarWindowProperty prop) {
+  return 1 << int(prop);
+}
+
 enum class OneG4TaskBarWindowState {
   Hidden = 0,
   FullScreen,
@@ -0,0 +1,140 @@
+/* panel/backends/oneg4windowgrid.h
+ * Window manager backend interfaces
+ */
+
+#ifndef ONEG4WINDOWGRID_H
+#define ONEG4WINDOWGRID_H
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+#include "oneg4taskbartypes.h"
+
+/*!
+ * \brief Per desktop grid of window frames for cheap overlap queries.
+ *
+ * Every frame is registered in the fixed size cells it touches, an area query only visits
+ * the windows sharing a cell with the area. Frames spanning too many cells (usually bogus
+ * geometry) are kept in a per desktop list which is always checked.
+ */
+class OneG4WindowGrid {
+ public:
+  // Adds the window, or moves it if already present
+  void insert(WId windowId, const QRect& frame, int desktop) {
+    auto it = mEntries.find(windowId);
+    if (it != mEntries.end()) {
+      if (it->frame == frame && it->desktop == desktop)
+        return;
+      unlink(windowId, *it);
+      it->frame = frame;
+      it->desktop = desktop;
+    }
+    else {
+      it = mEntries.insert(windowId, Entry{frame, desktop});
+    }
+    link(windowId, *it);
+  }
+
+  void remove(WId windowId) {
+    auto it = mEntries.find(windowId);
+    if (it == mEntries.end())
+      return;
+    unlink(windowId, *it);
+    mEntries.erase(it);
+  }
+
+  void clear() {
+    mEntries.clear();
+    mCells.clear();
+    mOversized.clear();
+  }
+
+  bool intersects(const QRect& area, int desktop) const {
+    if (!area.isValid())
+      return false;
+
+    const auto oversized = mOversized.constFind(desktop);
+    if (oversized != mOversized.cend()) {
+      for (WId windowId : *oversized) {
+        if (mEntries.value(windowId).frame.intersects(area))
+          return true;
+      }
+    }
+
+    const QRect cells = cellRange(area);
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+      for (int x = cells.left(); x <= cells.right(); ++x) {
+        const auto cell = mCells.constFind(cellKey(desktop, x, y));
+        if (cell == mCells.cend())
+          continue;
+        for (WId windowId : *cell) {
+          if (mEntries.value(windowId).frame.intersects(area))
+            return true;
+        }
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct Entry {
+    QRect frame;
+    int desktop = 0;
+  };
+
+  static constexpr int kCellShift = 8;  // 256x256 pixel cells
+  static constexpr int kMaxCells = 256;
+
+  static QRect cellRange(const QRect& rect) {
+    return QRect(QPoint(rect.left() >> kCellShift, rect.top() >> kCellShift),
+                 QPoint(rect.right() >> kCellShift, rect.bottom() >> kCellShift));
+  }
+
+  static quint64 cellKey(int desktop, int x, int y) {
+    return (quint64(quint16(desktop)) << 48) | (quint64(quint32(x) & 0xFFFFFF) << 24) | quint64(quint32(y) & 0xFFFFFF);
+  }
+
+  static bool isOversized(const QRect& cells) { return qint64(cells.width()) * cells.height() > kMaxCells; }
+
+  void link(WId windowId, const Entry& entry) {
+    if (!entry.frame.isValid())
+      return;
+    const QRect cells = cellRange(entry.frame);
+    if (isOversized(cells)) {
+      mOversized[entry.desktop].append(windowId);
+      return;
+    }
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+      for (int x = cells.left(); x <= cells.right(); ++x)
+        mCells[cellKey(entry.desktop, x, y)].append(windowId);
+    }
+  }
+
+  void unlink(WId windowId, const Entry& entry) {
+    if (!entry.frame.isValid())
+      return;
+    const QRect cells = cellRange(entry.frame);
+    if (isOversized(cells)) {
+      auto it = mOversized.find(entry.desktop);
+      it->removeOne(windowId);
+      if (it->isEmpty())
+        mOversized.erase(it);
+      return;
+    }
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+      for (int x = cells.left(); x <= cells.right(); ++x) {
+        auto it = mCells.find(cellKey(entry.desktop, x, y));
+        it->removeOne(windowId);
+        if (it->isEmpty())
+          mCells.erase(it);
+      }
+    }
+  }
+
+  QHash<WId, Entry> mEntries;
+  QHash<quint64, QVector<WId>> mCells;
+  QHash<int, QVector<WId>> mOversized;
+};
+
+#endif  // ONEG4WINDOWGRID_H
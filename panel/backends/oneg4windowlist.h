@@ -0,0 +1,76 @@
+/* panel/backends/oneg4windowlist.h
+ * Window manager backend interfaces
+ */
+
+#ifndef ONEG4WINDOWLIST_H
+#define ONEG4WINDOWLIST_H
+
+#include <QHash>
+#include <QVector>
+
+#include "oneg4taskbartypes.h"
+
+/*!
+ * \brief Insertion ordered set of window ids.
+ *
+ * Membership, insertion and removal are constant time. A removed window leaves a hole
+ * in the ordering vector, holes are squeezed out once they make up half of it.
+ */
+class OneG4WindowList {
+ public:
+  bool contains(WId windowId) const { return mIndex.contains(windowId); }
+  int count() const { return mIndex.count(); }
+  bool isEmpty() const { return mIndex.isEmpty(); }
+
+  bool append(WId windowId) {
+    if (windowId == 0 || mIndex.contains(windowId))
+      return false;
+
+    mIndex.insert(windowId, mOrder.count());
+    mOrder.append(windowId);
+    return true;
+  }
+
+  bool remove(WId windowId) {
+    auto it = mIndex.find(windowId);
+    if (it == mIndex.end())
+      return false;
+
+    mOrder[it.value()] = 0;
+    mIndex.erase(it);
+
+    if (mOrder.count() > 32 && mIndex.count() * 2 < mOrder.count())
+      compact();
+    return true;
+  }
+
+  void clear() {
+    mOrder.clear();
+    mIndex.clear();
+  }
+
+  QVector<WId> toVector() const {
+    if (mOrder.count() == mIndex.count())
+      return mOrder;
+
+    QVector<WId> windows;
+    windows.reserve(mIndex.count());
+    for (WId windowId : mOrder) {
+      if (windowId != 0)
+        windows.append(windowId);
+    }
+    return windows;
+  }
+
+ private:
+  void compact() {
+    mOrder = toVector();
+    for (int i = 0; i < mOrder.count(); ++i)
+      mIndex[mOrder.at(i)] = i;
+  }
+
+  QVector<WId> mOrder;  //!< windows in insertion order, 0 marks a removed entry
+  QHash<WId, int> mIndex;
+};
+
+#endif  // ONEG4WINDOWLIST_H
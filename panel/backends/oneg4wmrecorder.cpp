@@ -0,0 +1,111 @@
+/* panel/backends/oneg4wmrecorder.cpp
+ * Window manager backend interfaces
+ */
+
+#include "oneg4wmrecorder.h"
+
+#include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+
+#include "ioneg4abstractwmiface.h"
+
+OneG4WMRecorder::OneG4WMRecorder(IOneG4AbstractWMInterface* backend, const QString& fileName, QObject* parent)
+    : QObject(parent), mBackend(backend), mFile(fileName) {
+  if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "Cannot record window manager events to" << fileName << ":" << mFile.errorString();
+    return;
+  }
+
+  mStream.setDevice(&mFile);
+  mStream.setVersion(QDataStream::Qt_6_0);
+
+  const QVector<WId> windows = mBackend->getCurrentWindows();
+  mStream << kOneG4WMTraceMagic << kOneG4WMTraceVersion << qint32(mBackend->onAllWorkspacesEnum())
+          << qint32(mBackend->getWorkspacesCount()) << qint32(mBackend->getCurrentWorkspace())
+          << quint64(mBackend->getActiveWindow()) << qint32(windows.count());
+  for (WId windowId : windows)
+    mStream << quint64(windowId) << snapshot(windowId);
+
+  connect(mBackend, &IOneG4AbstractWMInterface::windowAdded, this, &OneG4WMRecorder::onWindowAdded);
+  connect(mBackend, &IOneG4AbstractWMInterface::windowRemoved, this, &OneG4WMRecorder::onWindowRemoved);
+  connect(mBackend, &IOneG4AbstractWMInterface::windowPropertiesChanged, this,
+          &OneG4WMRecorder::onWindowPropertiesChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::windowScreenChanged, this, &OneG4WMRecorder::onWindowScreenChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::activeWindowChanged, this, &OneG4WMRecorder::onActiveWindowChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::currentWorkspaceChanged, this,
+          &OneG4WMRecorder::onCurrentWorkspaceChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::workspacesCountChanged, this,
+          &OneG4WMRecorder::onWorkspacesCountChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::areaOverlapChanged, this, &OneG4WMRecorder::onAreaOverlapChanged);
+
+  mClock.start();
+  qDebug() << "Recording window manager events to" << fileName;
+}
+
+OneG4WMRecorder::~OneG4WMRecorder() {
+  if (mFile.isOpen())
+    mFile.close();
+}
+
+OneG4WMTraceWindow OneG4WMRecorder::snapshot(WId windowId) const {
+  OneG4WMTraceWindow window;
+  window.title = mBackend->getWindowTitle(windowId);
+  window.windowClass = mBackend->getWindowClass(windowId);
+  window.state = mBackend->getWindowState(windowId);
+  window.layer = mBackend->getWindowLayer(windowId);
+  window.workspace = mBackend->getWindowWorkspace(windowId);
+  window.demandsAttention = mBackend->applicationDemandsAttention(windowId);
+
+  const auto screens = QGuiApplication::screens();
+  for (QScreen* screen : screens) {
+    if (mBackend->isWindowOnScreen(screen, windowId))
+      window.screens << screen->name();
+  }
+  return window;
+}
+
+void OneG4WMRecorder::beginRecord(OneG4WMTraceEvent event) {
+  mStream << qint64(mClock.elapsed()) << quint8(event);
+}
+
+void OneG4WMRecorder::onWindowAdded(WId windowId) {
+  beginRecord(OneG4WMTraceEvent::WindowAdded);
+  mStream << quint64(windowId) << snapshot(windowId);
+}
+
+void OneG4WMRecorder::onWindowRemoved(WId windowId) {
+  beginRecord(OneG4WMTraceEvent::WindowRemoved);
+  mStream << quint64(windowId);
+}
+
+void OneG4WMRecorder::onWindowPropertiesChanged(WId windowId, int props) {
+  beginRecord(OneG4WMTraceEvent::WindowChanged);
+  mStream << quint64(windowId) << qint32(props) << snapshot(windowId);
+}
+
+void OneG4WMRecorder::onWindowScreenChanged(WId windowId) {
+  // screen layout changes move windows without touching their properties
+  onWindowPropertiesChanged(windowId, 0);
+}
+
+void OneG4WMRecorder::onActiveWindowChanged(WId windowId) {
+  beginRecord(OneG4WMTraceEvent::ActiveWindowChanged);
+  mStream << quint64(windowId);
+}
+
+void OneG4WMRecorder::onCurrentWorkspaceChanged(int idx) {
+  beginRecord(OneG4WMTraceEvent::CurrentWorkspaceChanged);
+  mStream << qint32(idx);
+}
+
+void OneG4WMRecorder::onWorkspacesCountChanged() {
+  beginRecord(OneG4WMTraceEvent::WorkspacesCountChanged);
+  mStream << qint32(mBackend->getWorkspacesCount());
+}
+
+void OneG4WMRecorder::onAreaOverlapChanged(const QRect& area, bool overlapped) {
+  // window geometries are not part of the trace, the verdicts for the watched areas are
+  beginRecord(OneG4WMTraceEvent::AreaOverlapChanged);
+  mStream << area << overlapped;
+}
@@ -0,0 +1,52 @@
+/* panel/backends/oneg4wmrecorder.h
+ * Window manager backend interfaces
+ */
+
+#ifndef ONEG4WMRECORDER_H
+#define ONEG4WMRECORDER_H
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+
+#include "oneg4wmtrace.h"
+
+class IOneG4AbstractWMInterface;
+
+/*!
+ * \brief Writes the signals of a backend, with what its getters answer, to a trace file.
+ *
+ * The trace can be fed back through OneG4ReplayWMBackend to reproduce the event stream
+ * the panel saw. See oneg4wmtrace.h for the file layout.
+ */
+class OneG4WMRecorder : public QObject {
+  Q_OBJECT
+
+ public:
+  OneG4WMRecorder(IOneG4AbstractWMInterface* backend, const QString& fileName, QObject* parent = nullptr);
+  ~OneG4WMRecorder() override;
+
+  bool isRecording() const { return mFile.isOpen(); }
+
+ private slots:
+  void onWindowAdded(WId windowId);
+  void onWindowRemoved(WId windowId);
+  void onWindowPropertiesChanged(WId windowId, int props);
+  void onWindowScreenChanged(WId windowId);
+  void onActiveWindowChanged(WId windowId);
+  void onCurrentWorkspaceChanged(int idx);
+  void onWorkspacesCountChanged();
+  void onAreaOverlapChanged(const QRect& area, bool overlapped);
+
+ private:
+  OneG4WMTraceWindow snapshot(WId windowId) const;
+  void beginRecord(OneG4WMTraceEvent event);
+
+  IOneG4AbstractWMInterface* mBackend;
+  QFile mFile;
+  QDataStream mStream;
+  QElapsedTimer mClock;
+};
+
+#endif  // ONEG4WMRECORDER_H
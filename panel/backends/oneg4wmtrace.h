@@ -0,0 +1,71 @@
+/* panel/backends/oneg4wmtrace.h
+ * Window manager backend interfaces
+ */
+
+#ifndef ONEG4WMTRACE_H
+#define ONEG4WMTRACE_H
+
+#include <QDataStream>
+#include <QRect>
+#include <QString>
+#include <QStringList>
+
+#include "oneg4taskbartypes.h"
+
+/*
+ * Trace file layout, written by OneG4WMRecorder and read by OneG4ReplayWMBackend:
+ *
+ *   header:  magic, version, all workspaces enum, workspaces count, current workspace,
+ *            active window, window count, (window id, OneG4WMTraceWindow) per window
+ *   records: msecs since the recording started, OneG4WMTraceEvent, payload
+ *
+ * Payloads:
+ *   WindowAdded             window id, OneG4WMTraceWindow
+ *   WindowRemoved           window id
+ *   WindowChanged           window id, windowPropertyMask() bits, OneG4WMTraceWindow
+ *   ActiveWindowChanged     window id
+ *   CurrentWorkspaceChanged workspace
+ *   WorkspacesCountChanged  workspaces count
+ *   AreaOverlapChanged      area, overlapped (version 2)
+ */
+
+constexpr quint32 kOneG4WMTraceMagic = 0x4f473457;  // "OG4W"
+constexpr quint16 kOneG4WMTraceVersion = 2;
+
+enum class OneG4WMTraceEvent : quint8 {
+  WindowAdded = 0,
+  WindowRemoved,
+  WindowChanged,
+  ActiveWindowChanged,
+  CurrentWorkspaceChanged,
+  WorkspacesCountChanged,
+  AreaOverlapChanged
+};
+
+// What the backend getters answered for a window at the time of the record
+struct OneG4WMTraceWindow {
+  QString title;
+  QString windowClass;
+  OneG4TaskBarWindowState state = OneG4TaskBarWindowState::Normal;
+  OneG4TaskBarWindowLayer layer = OneG4TaskBarWindowLayer::Normal;
+  int workspace = 0;
+  bool demandsAttention = false;
+  QStringList screens;  //!< names of the screens isWindowOnScreen() was true for
+};
+
+inline QDataStream& operator<<(QDataStream& stream, const OneG4WMTraceWindow& window) {
+  return stream << window.title << window.windowClass << qint32(window.state) << qint32(window.layer)
+                << qint32(window.workspace) << window.demandsAttention << window.screens;
+}
+
+inline QDataStream& operator>>(QDataStream& stream, OneG4WMTraceWindow& window) {
+  qint32 state, layer, workspace;
+  stream >> window.title >> window.windowClass >> state >> layer >> workspace >> window.demandsAttention >>
+      window.screens;
+  window.state = OneG4TaskBarWindowState(state);
+  window.layer = OneG4TaskBarWindowLayer(layer);
+  window.workspace = workspace;
+  return stream;
+}
+
+#endif  // ONEG4WMTRACE_H
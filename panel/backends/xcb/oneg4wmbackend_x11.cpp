@@ -12,107 +12,392 @@
 #include <NETWM>
 
 #include <QGuiApplication>
+#include <QIcon>
+#include <QImage>
+#include <QPixmap>
 #include <QScreen>
 #include <QTimer>
 #include <QCursor>
+#include <QSet>
 #include <QtMath>
 
 // NOTE: Xlib.h defines Bool which conflicts with QJsonValue::Type enum
 #include <X11/Xlib.h>
 #undef Bool
 
+#include <xcb/xcb.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace {
+// How long the window manager gets to apply an action before we carry on without it, in ms
+constexpr int kActionTimeout = 1000;
+
+// 512x512 plus the usual smaller sizes, larger icons are ignored
+const quint32 kMaxIconWords = 512 * 1024;
+
+/*!
+ * Reads _NET_WM_ICON of \p window and returns the best entry for \p devicePixels, scaled
+ * and premultiplied. Runs on a worker thread, xcb connections are thread safe.
+ */
+QImage readWindowIcon(xcb_connection_t* connection, xcb_atom_t atom, xcb_window_t window, int devicePixels) {
+  xcb_get_property_cookie_t cookie =
+      xcb_get_property(connection, false, window, atom, XCB_ATOM_CARDINAL, 0, kMaxIconWords);
+  xcb_generic_error_t* error = nullptr;
+  xcb_get_property_reply_t* reply = xcb_get_property_reply(connection, cookie, &error);
+  free(error);
+  if (!reply)
+    return QImage();
+
+  QImage image;
+  if (reply->format == 32) {
+    const quint32* data = static_cast<const quint32*>(xcb_get_property_value(reply));
+    const int count = xcb_get_property_value_length(reply) / 4;
+
+    // the smallest entry at least devicePixels big, otherwise the biggest one
+    const quint32* best = nullptr;
+    quint32 bestSize = 0;
+    for (int i = 0; i + 2 <= count;) {
+      const quint32 width = data[i];
+      const quint32 height = data[i + 1];
+      if (width == 0 || height == 0 || quint64(width) * height > quint64(count - i - 2))
+        break;
+
+      const quint32 size = qMax(width, height);
+      const bool bigEnough = size >= quint32(devicePixels);
+      const bool bestBigEnough = bestSize >= quint32(devicePixels);
+      const bool better = bigEnough ? (!bestBigEnough || size < bestSize) : (!bestBigEnough && size > bestSize);
+      if (!best || better) {
+        best = data + i;
+        bestSize = size;
+      }
+      i += 2 + width * height;
+    }
+
+    if (best) {
+      const int width = best[0];
+      const int height = best[1];
+      // CARDINALs are in host byte order, which is what Format_ARGB32 expects
+      image = QImage(width, height, QImage::Format_ARGB32);
+      for (int y = 0; y < height; ++y)
+        memcpy(image.scanLine(y), best + 2 + y * width, width * 4);
+
+      if (qMax(width, height) != devicePixels)
+        image = image.scaled(devicePixels, devicePixels, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+      image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+  }
+
+  free(reply);
+  return image;
+}
+}  // namespace
+
 OneG4WMBackendX11::OneG4WMBackendX11(QObject* parent) : IOneG4AbstractWMInterface(parent) {
   auto* x11Application = qGuiApp->nativeInterface<QNativeInterface::QX11Application>();
   Q_ASSERT_X(x11Application, "OneG4WMBackendX11", "Constructed without X11 connection");
   m_X11Display = x11Application->display();
   m_xcbConnection = x11Application->connection();
 
+  // same check KWindowInfo::actionSupported() does, but only once
+  m_allowedActionsSupported = NETRootInfo(m_xcbConnection, NET::Supported).isSupported(NET::WM2AllowedActions);
+  m_fetcher.reset(new OneG4X11WindowFetcher(m_xcbConnection, XDefaultRootWindow(m_X11Display)));
+
+  const char iconAtomName[] = "_NET_WM_ICON";
+  const char iconGeometryAtomName[] = "_NET_WM_ICON_GEOMETRY";
+  const xcb_intern_atom_cookie_t iconCookie =
+      xcb_intern_atom(m_xcbConnection, false, strlen(iconAtomName), iconAtomName);
+  const xcb_intern_atom_cookie_t iconGeometryCookie =
+      xcb_intern_atom(m_xcbConnection, false, strlen(iconGeometryAtomName), iconGeometryAtomName);
+  xcb_intern_atom_reply_t* iconAtom = xcb_intern_atom_reply(m_xcbConnection, iconCookie, nullptr);
+  m_netWmIconAtom = iconAtom ? iconAtom->atom : XCB_ATOM_NONE;
+  free(iconAtom);
+  xcb_intern_atom_reply_t* iconGeometryAtom = xcb_intern_atom_reply(m_xcbConnection, iconGeometryCookie, nullptr);
+  m_netWmIconGeometryAtom = iconGeometryAtom ? iconGeometryAtom->atom : XCB_ATOM_NONE;
+  free(iconGeometryAtom);
+  m_iconPool.setMaxThreadCount(2);
+
+  m_actionTimer.setSingleShot(true);
+  connect(&m_actionTimer, &QTimer::timeout, this, &OneG4WMBackendX11::expirePendingActions);
+
+  // overlap queries need every client, not only the ones shown in the taskbar
+  m_records = m_fetcher->fetch(KX11Extras::stackingOrder());
+  for (auto it = m_records.cbegin(); it != m_records.cend(); ++it)
+    updateOverlapIndex(it.key(), it.value());
+
+  // fills m_windowScreens for the records too
+  const auto screens = QGuiApplication::screens();
+  for (QScreen* screen : screens)
+    connect(screen, &QScreen::geometryChanged, this, [this] { rebuildScreenMap(); });
+  rebuildScreenMap();
+  connect(qGuiApp, &QGuiApplication::screenAdded, this, [this](QScreen* screen) {
+    connect(screen, &QScreen::geometryChanged, this, [this] { rebuildScreenMap(); });
+    rebuildScreenMap();
+  });
+  connect(qGuiApp, &QGuiApplication::screenRemoved, this, [this](QScreen* screen) { rebuildScreenMap(screen); });
+
   connect(KX11Extras::self(), &KX11Extras::windowChanged, this, &OneG4WMBackendX11::onWindowChanged);
   connect(KX11Extras::self(), &KX11Extras::windowAdded, this, &OneG4WMBackendX11::onWindowAdded);
   connect(KX11Extras::self(), &KX11Extras::windowRemoved, this, &OneG4WMBackendX11::onWindowRemoved);
 
   connect(KX11Extras::self(), &KX11Extras::numberOfDesktopsChanged, this,
           &IOneG4AbstractWMInterface::workspacesCountChanged);
-  connect(KX11Extras::self(), &KX11Extras::currentDesktopChanged, this,
-          [this](int x) { emit currentWorkspaceChanged(x, QString()); });
+  connect(KX11Extras::self(), &KX11Extras::currentDesktopChanged, this, [this](int x) {
+    for (WatchedArea& watched : m_watchedAreas)
+      refreshWatchedArea(watched);
+    emit currentWorkspaceChanged(x, QString());
+    checkPendingActions();
+  });
   connect(KX11Extras::self(), &KX11Extras::desktopNamesChanged, this, [this]() { emit workspaceNameChanged(-1); });
 
-  connect(KX11Extras::self(), &KX11Extras::activeWindowChanged, this, &IOneG4AbstractWMInterface::activeWindowChanged);
+  connect(KX11Extras::self(), &KX11Extras::activeWindowChanged, this, [this](WId windowId) {
+    emit activeWindowChanged(windowId);
+    checkPendingActions();
+  });
+}
+
+OneG4WMBackendX11::~OneG4WMBackendX11() {
+  // workers use the xcb connection and queue results to us
+  m_iconPool.clear();
+  m_iconPool.waitForDone();
 }
 
 /************************************************
  *   Model slots
  ************************************************/
 void OneG4WMBackendX11::onWindowChanged(WId windowId, NET::Properties prop, NET::Properties2 prop2) {
+  auto record = m_records.find(windowId);
+  if (record == m_records.end()) {
+    // a window we did not see being added, take a full snapshot of it
+    onWindowAdded(windowId);
+    return;
+  }
+
+  // refresh only what the server told us has changed
+  if (!fetchWindowRecord(windowId, prop, prop2, *record)) {
+    onWindowRemoved(windowId);
+    return;
+  }
+
+  if (prop & (NET::WMGeometry | NET::WMFrameExtents | NET::WMState | NET::WMDesktop | NET::WMWindowType))
+    updateOverlapIndex(windowId, *record);
+  if (prop & (NET::WMGeometry | NET::WMFrameExtents))
+    updateWindowScreen(windowId, *record);
+
+  // the record is up to date, see whether the window manager applied what we asked for
+  if (!m_pendingActions.isEmpty())
+    checkPendingActions(windowId);
+
+  const bool acceptanceChanged =
+      (prop & (NET::WMWindowType | NET::WMState)) || prop2.testFlag(NET::WM2TransientFor);
+
   if (!m_windows.contains(windowId)) {
     // if an unknown window changes in a way that makes it acceptable, add it to the taskbar
-    if (acceptWindow(windowId))
-      onWindowAdded(windowId);
+    if (acceptanceChanged && acceptWindow(windowId, *record))
+      addWindow_internal(windowId);
     return;
   }
 
-  if (!acceptWindow(windowId)) {
+  if (acceptanceChanged && !acceptWindow(windowId, *record)) {
     // if a known window changes in a way that makes it unacceptable, remove it from the taskbar
-    onWindowRemoved(windowId);
+    m_iconGeometries.remove(windowId);
+    m_windows.remove(windowId);
+    discardWindowPropertiesChanges(windowId);
+    emit windowRemoved(windowId);
     return;
   }
 
-  if (prop.testFlag(NET::WMGeometry))
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::Geometry));
+  int changed = 0;
+  if (prop & (NET::WMGeometry | NET::WMFrameExtents))
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::Geometry);
 
   if (prop2.testFlag(NET::WM2WindowClass))
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::WindowClass));
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::WindowClass);
 
   // window changed virtual desktop
   if (prop.testFlag(NET::WMDesktop))
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::Workspace));
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::Workspace);
 
   if (prop.testFlag(NET::WMVisibleName) || prop.testFlag(NET::WMName))
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::Title));
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::Title);
 
   // we are setting window icon geometry, no need to handle NET::WMIconGeometry
   // icon of the button can be based on windowClass
-  if (prop.testFlag(NET::WMIcon) || prop2.testFlag(NET::WM2WindowClass))
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::Icon));
+  if (prop.testFlag(NET::WMIcon) || prop2.testFlag(NET::WM2WindowClass)) {
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::Icon);
+    // reads already running return the previous icon
+    if (prop.testFlag(NET::WMIcon))
+      ++m_iconGenerations[windowId];
+  }
 
-  bool update_urgency = false;
   if (prop2.testFlag(NET::WM2Urgency))
-    update_urgency = true;
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::Urgency);
 
-  if (prop.testFlag(NET::WMState)) {
-    update_urgency = true;
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::State));
+  if (prop & (NET::WMState | NET::XAWMState)) {
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::State);
+    changed |= windowPropertyMask(OneG4TaskBarWindowProperty::Urgency);
   }
 
-  if (update_urgency)
-    emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::Urgency));
+  queueWindowPropertiesChange(windowId, changed);
 }
 
 void OneG4WMBackendX11::onWindowAdded(WId windowId) {
   if (m_windows.contains(windowId))
     return;
 
-  if (!acceptWindow(windowId))
+  auto record = m_records.find(windowId);
+  if (record == m_records.end()) {
+    const auto fetched = m_fetcher->fetch({windowId});
+    if (fetched.isEmpty())
+      return;
+    record = m_records.insert(windowId, fetched.constBegin().value());
+    updateOverlapIndex(windowId, *record);
+    updateWindowScreen(windowId, *record);
+  }
+
+  if (!acceptWindow(windowId, *record))
     return;
 
   addWindow_internal(windowId);
 }
 
 void OneG4WMBackendX11::onWindowRemoved(WId windowId) {
-  const int row = m_windows.indexOf(windowId);
-  if (row == -1)
+  m_records.remove(windowId);
+  removeFromOverlapIndex(windowId);
+  m_windowScreens.remove(windowId);
+  m_iconGenerations.remove(windowId);
+  if (m_iconRequests.removeIf([windowId](const auto& request) { return request.key().first == windowId; }))
+    emit windowIconRequestsCancelled(windowId);
+
+  // nothing will be applied to it any more, and there is nothing left to continue with
+  QList<PendingAction> orphaned;
+  for (auto it = m_pendingActions.begin(); it != m_pendingActions.end();) {
+    if (it->windowId == windowId) {
+      orphaned.append(*it);
+      it = m_pendingActions.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+  if (!orphaned.isEmpty()) {
+    scheduleActionTimeout();
+    for (const PendingAction& action : std::as_const(orphaned))
+      emit windowActionFinished(windowId, action.action, false);
+  }
+
+  if (!m_windows.remove(windowId))
     return;
 
   m_iconGeometries.remove(windowId);
-  m_windows.removeAt(row);
+  discardWindowPropertiesChanges(windowId);
 
   emit windowRemoved(windowId);
 }
 
+/************************************************
+ *   Asynchronous actions
+ ************************************************/
+void OneG4WMBackendX11::startAction(WId windowId,
+                                    OneG4TaskBarBackendAction action,
+                                    std::function<bool()> applied,
+                                    std::function<void(bool applied)> then) {
+  PendingAction pending{windowId, action, std::move(applied), std::move(then), QDeadlineTimer(kActionTimeout)};
+
+  // nothing to wait for, e.g. raising a window on the current desktop
+  if (pending.applied()) {
+    finishActions({pending}, true);
+    return;
+  }
+
+  m_pendingActions.append(pending);
+  scheduleActionTimeout();
+}
+
+void OneG4WMBackendX11::checkPendingActions(WId windowId) {
+  QList<PendingAction> done;
+  for (auto it = m_pendingActions.begin(); it != m_pendingActions.end();) {
+    if ((windowId == 0 || it->windowId == windowId) && it->applied()) {
+      done.append(*it);
+      it = m_pendingActions.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  if (done.isEmpty())
+    return;
+
+  scheduleActionTimeout();
+  finishActions(done, true);
+}
+
+void OneG4WMBackendX11::expirePendingActions() {
+  QList<PendingAction> expired;
+  for (auto it = m_pendingActions.begin(); it != m_pendingActions.end();) {
+    if (it->deadline.hasExpired()) {
+      expired.append(*it);
+      it = m_pendingActions.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  scheduleActionTimeout();
+  // carry on as if it was applied, some window managers don't report everything
+  finishActions(expired, false);
+}
+
+void OneG4WMBackendX11::finishActions(const QList<PendingAction>& actions, bool applied) {
+  // continuations may start further actions, these are already out of m_pendingActions
+  for (const PendingAction& action : actions) {
+    if (action.then)
+      action.then(applied);
+    emit windowActionFinished(action.windowId, action.action, applied);
+  }
+}
+
+void OneG4WMBackendX11::cancelRaiseActions() {
+  QList<PendingAction> cancelled;
+  for (auto it = m_pendingActions.begin(); it != m_pendingActions.end();) {
+    if (it->action == OneG4TaskBarBackendAction::DesktopSwitch || it->action == OneG4TaskBarBackendAction::Activate) {
+      cancelled.append(*it);
+      it = m_pendingActions.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  if (cancelled.isEmpty())
+    return;
+
+  scheduleActionTimeout();
+  // their continuations must not run, they would activate the superseded window
+  for (const PendingAction& action : std::as_const(cancelled))
+    emit windowActionFinished(action.windowId, action.action, false);
+}
+
+void OneG4WMBackendX11::scheduleActionTimeout() {
+  if (m_pendingActions.isEmpty()) {
+    m_actionTimer.stop();
+    return;
+  }
+
+  qint64 remaining = std::numeric_limits<qint64>::max();
+  for (const PendingAction& action : std::as_const(m_pendingActions))
+    remaining = qMin(remaining, action.deadline.remainingTime());
+  m_actionTimer.start(int(qMax<qint64>(0, remaining)));
+}
+
 /************************************************
  *   Model private functions
  ************************************************/
-bool OneG4WMBackendX11::acceptWindow(WId windowId) const {
+bool OneG4WMBackendX11::acceptWindow(WId windowId, const WindowRecord& record) const {
   QFlags<NET::WindowTypeMask> ignoreList;
   ignoreList |= NET::DesktopMask;
   ignoreList |= NET::DockMask;
@@ -122,32 +407,29 @@ bool OneG4WMBackendX11::acceptWindow(WId windowId) const {
   ignoreList |= NET::PopupMenuMask;
   ignoreList |= NET::NotificationMask;
 
-  KWindowInfo info(windowId, NET::WMWindowType | NET::WMState, NET::WM2TransientFor);
-  if (!info.valid())
-    return false;
-
-  if (NET::typeMatchesMask(info.windowType(NET::AllTypesMask), ignoreList))
+  if (NET::typeMatchesMask(record.windowType, ignoreList))
     return false;
 
-  if (info.state() & NET::SkipTaskbar)
+  if (record.state & NET::SkipTaskbar)
     return false;
 
   // WM_TRANSIENT_FOR hint not set means a normal window
-  WId transFor = info.transientFor();
+  WId transFor = record.transientFor;
 
   WId appRootWindow = XDefaultRootWindow(m_X11Display);
 
   if (transFor == 0 || transFor == windowId || transFor == appRootWindow)
     return true;
 
-  info = KWindowInfo(transFor, NET::WMWindowType);
+  // the parent is usually a window we already track
+  NET::WindowType transForType = lookupWindowRecord(transFor, NET::WMWindowType).windowType;
 
   QFlags<NET::WindowTypeMask> normalFlag;
   normalFlag |= NET::NormalMask;
   normalFlag |= NET::DialogMask;
   normalFlag |= NET::UtilityMask;
 
-  return !NET::typeMatchesMask(info.windowType(NET::AllTypesMask), normalFlag);
+  return !NET::typeMatchesMask(transForType, normalFlag);
 }
 
 void OneG4WMBackendX11::addWindow_internal(WId windowId) {
@@ -155,6 +437,187 @@ void OneG4WMBackendX11::addWindow_internal(WId windowId) {
   emit windowAdded(windowId);
 }
 
+bool OneG4WMBackendX11::isOverlapCandidate(const WindowRecord& record) const {
+  QFlags<NET::WindowTypeMask> ignoreList;
+  ignoreList |= NET::DesktopMask;
+  ignoreList |= NET::DockMask;
+  ignoreList |= NET::SplashMask;
+  ignoreList |= NET::MenuMask;
+  ignoreList |= NET::PopupMenuMask;
+  ignoreList |= NET::DropdownMenuMask;
+  ignoreList |= NET::TopMenuMask;
+  ignoreList |= NET::NotificationMask;
+
+  // skip shaded, minimized or hidden windows and the ignored types
+  return !(record.state & (NET::Shaded | NET::Hidden)) && !NET::typeMatchesMask(record.windowType, ignoreList);
+}
+
+void OneG4WMBackendX11::updateOverlapIndex(WId windowId, const WindowRecord& record) {
+  const bool candidate = isOverlapCandidate(record);
+  if (candidate)
+    m_overlapIndex.insert(windowId, record.frameGeometry, record.desktop);
+  else
+    m_overlapIndex.remove(windowId);
+
+  for (WatchedArea& watched : m_watchedAreas) {
+    const bool inside = candidate && record.frameGeometry.intersects(watched.area);
+    // a window staying inside may have changed desktop, so re-check that case too
+    if (inside)
+      watched.windows.insert(windowId);
+    else if (!watched.windows.remove(windowId))
+      continue;
+    refreshWatchedArea(watched);
+  }
+}
+
+void OneG4WMBackendX11::removeFromOverlapIndex(WId windowId) {
+  m_overlapIndex.remove(windowId);
+
+  for (WatchedArea& watched : m_watchedAreas) {
+    if (watched.windows.remove(windowId))
+      refreshWatchedArea(watched);
+  }
+}
+
+void OneG4WMBackendX11::rebuildScreenMap(QScreen* removed) {
+  m_screenRects.clear();
+  const auto screens = QGuiApplication::screens();
+  for (QScreen* screen : screens) {
+    if (screen != removed)
+      m_screenRects.append(qMakePair(screen, screen->geometry()));
+  }
+
+  for (auto it = m_records.cbegin(); it != m_records.cend(); ++it)
+    updateWindowScreen(it.key(), it.value());
+}
+
+QScreen* OneG4WMBackendX11::dominantScreen(const QRect& frame) const {
+  QScreen* dominant = nullptr;
+  qint64 dominantArea = 0;
+  for (const auto& screen : m_screenRects) {
+    const QRect common = screen.second.intersected(frame);
+    const qint64 area = qint64(common.width()) * common.height();
+    if (area > dominantArea) {
+      dominant = screen.first;
+      dominantArea = area;
+    }
+  }
+  return dominant;
+}
+
+void OneG4WMBackendX11::updateWindowScreen(WId windowId, const WindowRecord& record) {
+  QScreen* screen = dominantScreen(record.frameGeometry);
+  auto it = m_windowScreens.find(windowId);
+  if (it == m_windowScreens.end()) {
+    // consumers ask for the screen of a window when it is added
+    m_windowScreens.insert(windowId, screen);
+    return;
+  }
+  if (*it == screen)
+    return;
+
+  *it = screen;
+  if (m_windows.contains(windowId))
+    emit windowScreenChanged(windowId);
+}
+
+bool OneG4WMBackendX11::isWatchedAreaOverlapped(const WatchedArea& watched) const {
+  const int currentDesktop = KX11Extras::currentDesktop();
+  for (WId windowId : watched.windows) {
+    const int desktop = m_records.value(windowId).desktop;
+    if (desktop == currentDesktop || desktop == NET::OnAllDesktops)
+      return true;
+  }
+  return false;
+}
+
+void OneG4WMBackendX11::refreshWatchedArea(WatchedArea& watched) {
+  const bool overlapped = isWatchedAreaOverlapped(watched);
+  if (overlapped == watched.overlapped)
+    return;
+
+  watched.overlapped = overlapped;
+  emit areaOverlapChanged(watched.area, overlapped);
+}
+
+/*!
+ * Reads the properties selected by \p prop and \p prop2 from the X server and stores them in
+ * \p record, leaving the other fields untouched. Returns false if the window no longer exists.
+ */
+bool OneG4WMBackendX11::fetchWindowRecord(WId windowId,
+                                          NET::Properties prop,
+                                          NET::Properties2 prop2,
+                                          WindowRecord& record) const {
+  NET::Properties infoProp;
+  NET::Properties2 infoProp2;
+  if (prop & (NET::WMName | NET::WMVisibleName))
+    infoProp |= NET::WMName | NET::WMVisibleName;
+  if (prop & NET::WMDesktop)
+    infoProp |= NET::WMDesktop;
+  if (prop & (NET::WMState | NET::XAWMState))
+    infoProp |= NET::WMState | NET::XAWMState;
+  if (prop & NET::WMWindowType)
+    infoProp |= NET::WMWindowType;
+  if (prop & (NET::WMGeometry | NET::WMFrameExtents))
+    infoProp |= NET::WMGeometry | NET::WMFrameExtents;
+  if (prop2 & NET::WM2WindowClass)
+    infoProp2 |= NET::WM2WindowClass;
+  if (prop2 & NET::WM2TransientFor)
+    infoProp2 |= NET::WM2TransientFor;
+
+  if (infoProp || infoProp2) {
+    KWindowInfo info(windowId, infoProp, infoProp2);
+    if (!info.valid())
+      return false;
+
+    if (infoProp & NET::WMName)
+      record.title = info.visibleName().isEmpty() ? info.name() : info.visibleName();
+    if (infoProp & NET::WMDesktop)
+      record.desktop = info.desktop();
+    if (infoProp & NET::WMState) {
+      record.state = info.state();
+      record.minimized = info.isMinimized();
+    }
+    if (infoProp & NET::WMWindowType)
+      record.windowType = info.windowType(NET::AllTypesMask);
+    if (infoProp & NET::WMGeometry) {
+      record.geometry = info.geometry();
+      record.frameGeometry = info.frameGeometry();
+    }
+    if (infoProp2 & NET::WM2WindowClass)
+      record.windowClass = QString::fromUtf8(info.windowClassClass());
+    if (infoProp2 & NET::WM2TransientFor)
+      record.transientFor = info.transientFor();
+  }
+
+  const NET::Properties2 netProp2 = prop2 & (NET::WM2Urgency | NET::WM2AllowedActions);
+  if (netProp2) {
+    WId appRootWindow = XDefaultRootWindow(m_X11Display);
+    NETWinInfo info(m_xcbConnection, windowId, appRootWindow, NET::Properties(), netProp2);
+    if (netProp2 & NET::WM2Urgency)
+      record.urgency = info.urgency();
+    if (netProp2 & NET::WM2AllowedActions)
+      record.allowedActions = info.allowedActions();
+  }
+
+  return true;
+}
+
+/*!
+ * Returns the cached record of \p windowId. Windows we do not track are queried on the fly,
+ * in which case only the fields selected by \p prop and \p prop2 are filled.
+ */
+auto OneG4WMBackendX11::lookupWindowRecord(WId windowId, NET::Properties prop, NET::Properties2 prop2) const
+    -> WindowRecord {
+  const auto cached = m_records.constFind(windowId);
+  if (cached != m_records.cend())
+    return *cached;
+
+  WindowRecord record;
+  fetchWindowRecord(windowId, prop, prop2, record);
+  return record;
+}
+
 /************************************************
  *   Windows function
  ************************************************/
@@ -206,33 +669,60 @@ bool OneG4WMBackendX11::supportsAction(WId windowId, OneG4TaskBarBackendAction a
     case OneG4TaskBarBackendAction::MoveToOutput:
       return true;
 
+    case OneG4TaskBarBackendAction::Activate:
+      return true;
+
     default:
       return false;
   }
 
-  KWindowInfo info(windowId, NET::Properties(), NET::WM2AllowedActions);
-  return info.actionSupported(x11Action);
+  if (!m_allowedActionsSupported)
+    return true;
+
+  return lookupWindowRecord(windowId, NET::Properties(), NET::WM2AllowedActions).allowedActions.testFlag(x11Action);
 }
 
 bool OneG4WMBackendX11::reloadWindows() {
-  QVector<WId> knownWindows;
+  OneG4WindowList knownWindows;
   qSwap(knownWindows, m_windows);
-  QList<WId> new_list;
 
   // just add new windows to groups, deleting is up to the groups
   const auto wnds = KX11Extras::stackingOrder();
+  const QSet<WId> stacked(wnds.cbegin(), wnds.cend());
+
+  // read all windows we have no record of in one go
+  QList<WId> unknown;
+  for (auto const wnd : wnds) {
+    if (!m_records.contains(wnd))
+      unknown.append(wnd);
+  }
+  const auto fetched = m_fetcher->fetch(unknown);
+  m_records.insert(fetched);
+  for (auto it = fetched.cbegin(); it != fetched.cend(); ++it) {
+    updateOverlapIndex(it.key(), it.value());
+    updateWindowScreen(it.key(), it.value());
+  }
+
   for (auto const wnd : wnds) {
-    if (acceptWindow(wnd)) {
-      new_list << wnd;
+    auto record = m_records.constFind(wnd);
+    if (record == m_records.cend())
+      continue;
+
+    if (acceptWindow(wnd, *record))
       addWindow_internal(wnd);
-    }
   }
 
   // emulate windowRemoved if known window not reported by KWindowSystem
-  for (auto i = knownWindows.begin(), i_e = knownWindows.end(); i != i_e; ++i) {
-    WId wnd = *i;
-    if (!new_list.contains(wnd)) {
+  const auto known = knownWindows.toVector();
+  for (WId wnd : known) {
+    if (!m_windows.contains(wnd)) {
       m_iconGeometries.remove(wnd);
+      discardWindowPropertiesChanges(wnd);
+      if (!stacked.contains(wnd)) {
+        m_records.remove(wnd);
+        removeFromOverlapIndex(wnd);
+        m_windowScreens.remove(wnd);
+      }
       emit windowRemoved(wnd);
     }
   }
@@ -243,32 +733,58 @@ bool OneG4WMBackendX11::reloadWindows() {
 }
 
 QVector<WId> OneG4WMBackendX11::getCurrentWindows() const {
-  return m_windows;
+  return m_windows.toVector();
 }
 
 QString OneG4WMBackendX11::getWindowTitle(WId windowId) const {
-  KWindowInfo info(windowId, NET::WMVisibleName | NET::WMName);
-  QString title = info.visibleName().isEmpty() ? info.name() : info.visibleName();
-  return title;
+  return lookupWindowRecord(windowId, NET::WMVisibleName | NET::WMName).title;
 }
 
 bool OneG4WMBackendX11::applicationDemandsAttention(WId windowId) const {
-  WId appRootWindow = XDefaultRootWindow(m_X11Display);
-  return NETWinInfo(m_xcbConnection, windowId, appRootWindow, NET::Properties{}, NET::WM2Urgency).urgency() ||
-         KWindowInfo{windowId, NET::WMState}.hasState(NET::DemandsAttention);
+  const WindowRecord record = lookupWindowRecord(windowId, NET::WMState, NET::WM2Urgency);
+  return record.urgency || record.state.testFlag(NET::DemandsAttention);
 }
 
 QIcon OneG4WMBackendX11::getApplicationIcon(WId windowId, int devicePixels) const {
   return KX11Extras::icon(windowId, devicePixels, devicePixels);
 }
 
+bool OneG4WMBackendX11::requestApplicationIcon(WId windowId, int devicePixels) {
+  if (m_netWmIconAtom == XCB_ATOM_NONE || devicePixels <= 0)
+    return false;
+
+  // one answer serves all requests made meanwhile, unless the icon changed since the read started
+  const quint32 generation = m_iconGenerations.value(windowId);
+  auto request = m_iconRequests.constFind({windowId, devicePixels});
+  if (m_iconRequests.cend() != request && *request == generation)
+    return true;
+  m_iconRequests.insert({windowId, devicePixels}, generation);
+
+  xcb_connection_t* connection = m_xcbConnection;
+  const xcb_atom_t atom = m_netWmIconAtom;
+  m_iconPool.start([this, connection, atom, windowId, devicePixels, generation] {
+    const QImage image = readWindowIcon(connection, atom, windowId, devicePixels);
+    QMetaObject::invokeMethod(
+        this,
+        [this, windowId, devicePixels, generation, image] {
+          // a newer read answers instead, or the window is gone and its requests were cancelled
+          if (!m_records.contains(windowId) || m_iconGenerations.value(windowId) != generation)
+            return;
+          m_iconRequests.remove({windowId, devicePixels});
+          // pixmaps may only be created on the GUI thread
+          emit windowIconReady(windowId, devicePixels, image.isNull() ? QIcon() : QIcon(QPixmap::fromImage(image)));
+        },
+        Qt::QueuedConnection);
+  });
+  return true;
+}
+
 QString OneG4WMBackendX11::getWindowClass(WId windowId) const {
-  KWindowInfo info(windowId, NET::Properties(), NET::WM2WindowClass);
-  return QString::fromUtf8(info.windowClassClass());
+  return lookupWindowRecord(windowId, NET::Properties(), NET::WM2WindowClass).windowClass;
 }
 
 OneG4TaskBarWindowLayer OneG4WMBackendX11::getWindowLayer(WId windowId) const {
-  NET::States state = KWindowInfo(windowId, NET::WMState).state();
+  NET::States state = lookupWindowRecord(windowId, NET::WMState).state;
   if (state.testFlag(NET::KeepAbove))
     return OneG4TaskBarWindowLayer::KeepAbove;
   else if (state.testFlag(NET::KeepBelow))
@@ -298,11 +814,11 @@ bool OneG4WMBackendX11::setWindowLayer(WId windowId, OneG4TaskBarWindowLayer lay
 }
 
 OneG4TaskBarWindowState OneG4WMBackendX11::getWindowState(WId windowId) const {
-  KWindowInfo info(windowId, NET::WMState | NET::XAWMState);
-  if (info.isMinimized())
+  const WindowRecord record = lookupWindowRecord(windowId, NET::WMState | NET::XAWMState);
+  if (record.minimized)
     return OneG4TaskBarWindowState::Minimized;
 
-  NET::States state = info.state();
+  NET::States state = record.state;
   if (state.testFlag(NET::Hidden))
     return OneG4TaskBarWindowState::Hidden;
   if (state.testFlag(NET::Max))
@@ -369,18 +885,40 @@ bool OneG4WMBackendX11::isWindowActive(WId windowId) const {
 }
 
 bool OneG4WMBackendX11::raiseWindow(WId windowId, bool onCurrentWorkSpace) {
+  int desktop = getCurrentWorkspace();
   if (onCurrentWorkSpace && getWindowState(windowId) == OneG4TaskBarWindowState::Minimized) {
-    setWindowOnWorkspace(windowId, getCurrentWorkspace());
+    setWindowOnWorkspace(windowId, desktop);
   }
   else {
-    setCurrentWorkspace(getWindowWorkspace(windowId));
+    desktop = getWindowWorkspace(windowId);
   }
 
-  // bypass focus stealing prevention
-  KX11Extras::forceActiveWindow(windowId);
+  // on all desktops or no _NET_WM_DESKTOP at all, there is no desktop to switch to
+  const bool switchDesktop = desktop >= 1 && desktop <= KX11Extras::numberOfDesktops();
+  if (switchDesktop)
+    setCurrentWorkspace(desktop);
 
   // clear urgency flag
-  emit windowPropertyChanged(windowId, int(OneG4TaskBarWindowProperty::Urgency));
+  queueWindowPropertiesChange(windowId, windowPropertyMask(OneG4TaskBarWindowProperty::Urgency));
+
+  // the latest raise wins, an earlier one finishing later would steal the focus back
+  cancelRaiseActions();
+
+  // activating before the window manager switched desktops can make it switch back, so the
+  // activation follows the desktop change instead of being sent right behind it
+  startAction(
+      windowId, OneG4TaskBarBackendAction::DesktopSwitch,
+      [desktop, switchDesktop] { return !switchDesktop || KX11Extras::currentDesktop() == desktop; },
+      [this, windowId](bool applied) {
+        // bypass focus stealing prevention, unless the desktop never switched and the window
+        // manager should decide whether to follow
+        if (applied)
+          KX11Extras::forceActiveWindow(windowId);
+        else
+          KX11Extras::activateWindow(windowId);
+        startAction(windowId, OneG4TaskBarBackendAction::Activate,
+                    [windowId] { return KX11Extras::activeWindow() == windowId; });
+      });
 
   return true;
 }
@@ -419,8 +957,7 @@ bool OneG4WMBackendX11::setCurrentWorkspace(int idx, QScreen*) {
 }
 
 int OneG4WMBackendX11::getWindowWorkspace(WId windowId) const {
-  KWindowInfo info(windowId, NET::WMDesktop);
-  return info.desktop();
+  return lookupWindowRecord(windowId, NET::WMDesktop).desktop;
 }
 
 bool OneG4WMBackendX11::setWindowOnWorkspace(WId windowId, int idx) {
@@ -460,10 +997,18 @@ void OneG4WMBackendX11::moveApplicationToPrevNextMonitor(WId windowId, bool next
         KX11Extras::clearState(windowId, NET::MaxHoriz | NET::MaxVert | NET::Max | NET::FullScreen);
         NETRootInfo(m_xcbConnection, NET::Properties(), NET::WM2MoveResizeWindow)
             .moveResizeWindowRequest(windowId, flags, X, Y, 0, 0);
-        QTimer::singleShot(200, this, [this, windowId, state, raiseOnCurrentDesktop] {
-          KX11Extras::setState(windowId, state);
-          raiseWindow(windowId, raiseOnCurrentDesktop);
-        });
+
+        // the state is restored once the window manager reports the window on the other screen
+        startAction(
+            windowId, OneG4TaskBarBackendAction::MoveToOutput,
+            [this, windowId, targetScreenGeometry] {
+              auto record = m_records.constFind(windowId);
+              return record != m_records.cend() && targetScreenGeometry.contains(record->frameGeometry.center());
+            },
+            [this, windowId, state, raiseOnCurrentDesktop](bool) {
+              KX11Extras::setState(windowId, state);
+              raiseWindow(windowId, raiseOnCurrentDesktop);
+            });
         break;
       }
     }
@@ -479,8 +1024,8 @@ bool OneG4WMBackendX11::isWindowOnScreen(QScreen* screen, WId windowId) const {
   if (!screen)
     return true;
 
-  QRect r = KWindowInfo(windowId, NET::WMFrameExtents).frameGeometry();
-  return screen->geometry().intersects(r);
+  // a window belongs to the screen showing the biggest part of it
+  return m_windowScreens.value(windowId) == screen;
 }
 
 bool OneG4WMBackendX11::setDesktopLayout(Qt::Orientation orientation, int rows, int columns, bool rightToLeft) {
@@ -536,6 +1081,21 @@ void OneG4WMBackendX11::resizeApplication(WId windowId) {
 }
 
 void OneG4WMBackendX11::refreshIconGeometry(WId windowId, QRect const& geom) {
+  if (writeIconGeometry(windowId, geom))
+    xcb_flush(m_xcbConnection);
+}
+
+void OneG4WMBackendX11::refreshIconGeometries(const QHash<WId, QRect>& geometries) {
+  bool written = false;
+  for (auto it = geometries.cbegin(); it != geometries.cend(); ++it)
+    written |= writeIconGeometry(it.key(), it.value());
+
+  // one flush for the whole layout pass, nothing waits for a reply
+  if (written)
+    xcb_flush(m_xcbConnection);
+}
+
+bool OneG4WMBackendX11::writeIconGeometry(WId windowId, const QRect& geom) {
   // announce where the task icon is so X11 WMs can perform animations correctly
 
   const qreal scaleFactor = qApp->devicePixelRatio();
@@ -543,49 +1103,52 @@ void OneG4WMBackendX11::refreshIconGeometry(WId windowId, QRect const& geom) {
                          qRound(geom.width() * scaleFactor), qRound(geom.height() * scaleFactor));
 
   const auto cached = m_iconGeometries.value(windowId);
-  if (cached == scaledGeom)
-    return;
+  if (cached == scaledGeom || m_netWmIconGeometryAtom == XCB_ATOM_NONE)
+    return false;
 
   m_iconGeometries.insert(windowId, scaledGeom);
 
-  WId appRootWindow = XDefaultRootWindow(m_X11Display);
-  NETWinInfo info(m_xcbConnection, windowId, appRootWindow, NET::Properties(), NET::Properties2());
-
-  NETRect nrect;
-  nrect.pos.x = geom.x();
-  nrect.pos.y = geom.y();
-  nrect.size.height = geom.height();
-  nrect.size.width = geom.width();
-  info.setIconGeometry(nrect);
+  // the value NETWinInfo::setIconGeometry() writes, without the NETWinInfo which reads the
+  // window's properties first; errors for windows gone meanwhile end up in the event queue
+  const quint32 data[] = {quint32(geom.x()), quint32(geom.y()), quint32(geom.width()), quint32(geom.height())};
+  xcb_change_property(m_xcbConnection, XCB_PROP_MODE_REPLACE, windowId, m_netWmIconGeometryAtom, XCB_ATOM_CARDINAL,
+                      32, 4, data);
+  return true;
 }
 
 bool OneG4WMBackendX11::isAreaOverlapped(const QRect& area) const {
-  // TODO: reuse our m_windows cache
-  QFlags<NET::WindowTypeMask> ignoreList;
-  ignoreList |= NET::DesktopMask;
-  ignoreList |= NET::DockMask;
-  ignoreList |= NET::SplashMask;
-  ignoreList |= NET::MenuMask;
-  ignoreList |= NET::PopupMenuMask;
-  ignoreList |= NET::DropdownMenuMask;
-  ignoreList |= NET::TopMenuMask;
-  ignoreList |= NET::NotificationMask;
+  // skip windows that are on other desktops
+  return m_overlapIndex.intersects(area, KX11Extras::currentDesktop()) ||
+         m_overlapIndex.intersects(area, NET::OnAllDesktops);
+}
 
-  const auto wIds = KX11Extras::stackingOrder();
-  for (auto const wId : wIds) {
-    KWindowInfo info(wId, NET::WMWindowType | NET::WMState | NET::WMFrameExtents | NET::WMDesktop);
-    if (info.valid()
-        // skip windows that are on other desktops
-        && info.isOnCurrentDesktop()
-        // skip shaded, minimized or hidden windows
-        && !(info.state() & (NET::Shaded | NET::Hidden))
-        // check against the list of ignored types
-        && !NET::typeMatchesMask(info.windowType(NET::AllTypesMask), ignoreList)) {
-      if (info.frameGeometry().intersects(area))
-        return true;
+void OneG4WMBackendX11::watchArea(const QRect& area) {
+  for (WatchedArea& watched : m_watchedAreas) {
+    if (watched.area == area) {
+      ++watched.refs;
+      return;
+    }
+  }
+
+  WatchedArea watched;
+  watched.area = area;
+  watched.refs = 1;
+  for (auto it = m_records.cbegin(); it != m_records.cend(); ++it) {
+    if (isOverlapCandidate(it.value()) && it.value().frameGeometry.intersects(area))
+      watched.windows.insert(it.key());
+  }
+  watched.overlapped = isWatchedAreaOverlapped(watched);
+  m_watchedAreas.append(watched);
+}
+
+void OneG4WMBackendX11::unwatchArea(const QRect& area) {
+  for (int i = 0; i < m_watchedAreas.count(); ++i) {
+    if (m_watchedAreas.at(i).area == area) {
+      if (--m_watchedAreas[i].refs == 0)
+        m_watchedAreas.remove(i);
+      return;
     }
   }
-  return false;
 }
 
 bool OneG4WMBackendX11::isShowingDesktop() const {
@@ -6,10 +6,22 @@
 #define ONEG4_WM_BACKEND_X11_H
 
 #include "../ioneg4abstractwmiface.h"
+#include "../oneg4windowgrid.h"
+#include "../oneg4windowlist.h"
+#include "oneg4x11windowfetcher.h"
 
+#include <QDeadlineTimer>
 #include <QHash>
+#include <QList>
+#include <QRect>
+#include <QScopedPointer>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
 #include <netwm_def.h>
 
+#include <functional>
+
 typedef struct _XDisplay Display;
 struct xcb_connection_t;
 
@@ -18,6 +30,7 @@ class OneG4WMBackendX11 : public IOneG4AbstractWMInterface {
 
  public:
   explicit OneG4WMBackendX11(QObject* parent = nullptr);
+  ~OneG4WMBackendX11() override;
 
   // Backend
   virtual bool supportsAction(WId windowId, OneG4TaskBarBackendAction action) const override;
@@ -29,6 +42,7 @@ class OneG4WMBackendX11 : public IOneG4AbstractWMInterface {
   virtual QString getWindowTitle(WId windowId) const override;
   virtual bool applicationDemandsAttention(WId windowId) const override;
   virtual QIcon getApplicationIcon(WId windowId, int devicePixels) const override;
+  virtual bool requestApplicationIcon(WId windowId, int devicePixels) override;
   virtual QString getWindowClass(WId windowId) const override;
 
   virtual OneG4TaskBarWindowLayer getWindowLayer(WId windowId) const override;
@@ -67,9 +81,12 @@ class OneG4WMBackendX11 : public IOneG4AbstractWMInterface {
   virtual void resizeApplication(WId windowId) override;
 
   virtual void refreshIconGeometry(WId windowId, const QRect& geom) override;
+  void refreshIconGeometries(const QHash<WId, QRect>& geometries) override;
 
   // Panel internal
   virtual bool isAreaOverlapped(const QRect& area) const override;
+  virtual void watchArea(const QRect& area) override;
+  virtual void unwatchArea(const QRect& area) override;
 
   // Show Destop
   virtual bool isShowingDesktop() const override;
@@ -81,15 +98,82 @@ class OneG4WMBackendX11 : public IOneG4AbstractWMInterface {
   void onWindowRemoved(WId windowId);
 
  private:
-  bool acceptWindow(WId windowId) const;
+  // Client side copy of the window properties we care about, kept up to date
+  // from the property deltas reported by KX11Extras::windowChanged
+  using WindowRecord = OneG4X11WindowRecord;
+
+  bool acceptWindow(WId windowId, const WindowRecord& record) const;
   void addWindow_internal(WId windowId);
+  bool isOverlapCandidate(const WindowRecord& record) const;
+  void updateOverlapIndex(WId windowId, const WindowRecord& record);
+  void removeFromOverlapIndex(WId windowId);
+
+  // An area registered by watchArea() and the overlap candidates intersecting it
+  struct WatchedArea {
+    QRect area;
+    int refs = 0;
+    QSet<WId> windows;
+    bool overlapped = false;
+  };
+
+  // Screen map, removed is skipped as it may still be listed while being removed
+  void rebuildScreenMap(QScreen* removed = nullptr);
+  QScreen* dominantScreen(const QRect& frame) const;
+  void updateWindowScreen(WId windowId, const WindowRecord& record);
+
+  bool isWatchedAreaOverlapped(const WatchedArea& watched) const;
+  void refreshWatchedArea(WatchedArea& watched);
+
+  // A request sent to the window manager, finished once applied() holds or the deadline passed.
+  // then runs either way unless the action is cancelled, windowActionFinished() is emitted after it.
+  struct PendingAction {
+    WId windowId;
+    OneG4TaskBarBackendAction action;
+    std::function<bool()> applied;
+    std::function<void(bool applied)> then;
+    QDeadlineTimer deadline;
+  };
+
+  void startAction(WId windowId,
+                   OneG4TaskBarBackendAction action,
+                   std::function<bool()> applied,
+                   std::function<void(bool applied)> then = {});
+  // Finishes the actions of windowId (all if 0) the window manager has applied
+  void checkPendingActions(WId windowId = 0);
+  void expirePendingActions();
+  void finishActions(const QList<PendingAction>& actions, bool applied);
+  // Drops the pending steps of earlier raiseWindow() calls without running their continuations
+  void cancelRaiseActions();
+  void scheduleActionTimeout();
+
+  // Queues the property write if the geometry changed, the caller flushes
+  bool writeIconGeometry(WId windowId, const QRect& geom);
+
+  bool fetchWindowRecord(WId windowId, NET::Properties prop, NET::Properties2 prop2, WindowRecord& record) const;
+  WindowRecord lookupWindowRecord(WId windowId, NET::Properties prop, NET::Properties2 prop2 = NET::Properties2()) const;
 
  private:
   Display* m_X11Display;
   xcb_connection_t* m_xcbConnection;
-
-  QVector<WId> m_windows;
+  bool m_allowedActionsSupported;
+  QScopedPointer<OneG4X11WindowFetcher> m_fetcher;
+
+  OneG4WindowList m_windows;
+  QHash<WId, WindowRecord> m_records;
+  OneG4WindowGrid m_overlapIndex;  //!< frames of the windows isAreaOverlapped() considers
+  QVector<WatchedArea> m_watchedAreas;
+  QVector<QPair<QScreen*, QRect>> m_screenRects;
+  QHash<WId, QScreen*> m_windowScreens;  //!< screen showing the biggest part of each window
   QHash<WId, QRect> m_iconGeometries;
+  QList<PendingAction> m_pendingActions;
+  QTimer m_actionTimer;
+  quint32 m_netWmIconGeometryAtom;
+
+  // _NET_WM_ICON is read and decoded off the GUI thread
+  QThreadPool m_iconPool;
+  quint32 m_netWmIconAtom;
+  QHash<QPair<WId, int>, quint32> m_iconRequests;  //!< reads in flight, with the icon generation they read
+  QHash<WId, quint32> m_iconGenerations;           //!< bumped when _NET_WM_ICON changes
 };
 
 class OneG4WMBackendX11Library : public QObject, public IOneG4WMBackendLibrary {
@@ -0,0 +1,388 @@
+/* panel/backends/xcb/oneg4x11windowfetcher.cpp
+ * Window manager backend interfaces
+ */
+
+#include "oneg4x11windowfetcher.h"
+
+#include <NETWM>
+
+#include <QScopedPointer>
+
+#include <xcb/xcb.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+// in the order of OneG4X11WindowFetcher::Atom
+const char* const kAtomNames[] = {
+    "UTF8_STRING",
+    "_NET_WM_NAME",
+    "_NET_WM_VISIBLE_NAME",
+    "_NET_WM_DESKTOP",
+    "_NET_WM_STATE",
+    "_NET_WM_WINDOW_TYPE",
+    "_NET_WM_ALLOWED_ACTIONS",
+    "_NET_FRAME_EXTENTS",
+    "WM_STATE",
+
+    "_NET_WM_WINDOW_TYPE_NORMAL",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_TOOLBAR",
+    "_NET_WM_WINDOW_TYPE_MENU",
+    "_NET_WM_WINDOW_TYPE_DIALOG",
+    "_NET_WM_WINDOW_TYPE_UTILITY",
+    "_NET_WM_WINDOW_TYPE_SPLASH",
+    "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU",
+    "_NET_WM_WINDOW_TYPE_POPUP_MENU",
+    "_NET_WM_WINDOW_TYPE_TOOLTIP",
+    "_NET_WM_WINDOW_TYPE_NOTIFICATION",
+    "_NET_WM_WINDOW_TYPE_COMBO",
+    "_NET_WM_WINDOW_TYPE_DND",
+    "_KDE_NET_WM_WINDOW_TYPE_OVERRIDE",
+    "_KDE_NET_WM_WINDOW_TYPE_TOPMENU",
+    "_KDE_NET_WM_WINDOW_TYPE_ON_SCREEN_DISPLAY",
+    "_KDE_NET_WM_WINDOW_TYPE_CRITICAL_NOTIFICATION",
+    "_KDE_NET_WM_WINDOW_TYPE_APPLET_POPUP",
+
+    "_NET_WM_STATE_MODAL",
+    "_NET_WM_STATE_STICKY",
+    "_NET_WM_STATE_MAXIMIZED_VERT",
+    "_NET_WM_STATE_MAXIMIZED_HORZ",
+    "_NET_WM_STATE_SHADED",
+    "_NET_WM_STATE_SKIP_TASKBAR",
+    "_NET_WM_STATE_SKIP_PAGER",
+    "_NET_WM_STATE_HIDDEN",
+    "_NET_WM_STATE_FULLSCREEN",
+    "_NET_WM_STATE_ABOVE",
+    "_NET_WM_STATE_BELOW",
+    "_NET_WM_STATE_DEMANDS_ATTENTION",
+    "_NET_WM_STATE_FOCUSED",
+    "_KDE_NET_WM_STATE_SKIP_SWITCHER",
+
+    "_NET_WM_ACTION_MOVE",
+    "_NET_WM_ACTION_RESIZE",
+    "_NET_WM_ACTION_MINIMIZE",
+    "_NET_WM_ACTION_SHADE",
+    "_NET_WM_ACTION_STICK",
+    "_NET_WM_ACTION_MAXIMIZE_VERT",
+    "_NET_WM_ACTION_MAXIMIZE_HORZ",
+    "_NET_WM_ACTION_FULLSCREEN",
+    "_NET_WM_ACTION_CHANGE_DESKTOP",
+    "_NET_WM_ACTION_CLOSE",
+};
+
+const NET::WindowType kWindowTypes[] = {
+    NET::Normal,
+    NET::Desktop,
+    NET::Dock,
+    NET::Toolbar,
+    NET::Menu,
+    NET::Dialog,
+    NET::Utility,
+    NET::Splash,
+    NET::DropdownMenu,
+    NET::PopupMenu,
+    NET::Tooltip,
+    NET::Notification,
+    NET::ComboBox,
+    NET::DNDIcon,
+    NET::Override,
+    NET::TopMenu,
+    NET::OnScreenDisplay,
+    NET::CriticalNotification,
+    NET::AppletPopup,
+};
+
+const NET::State kStates[] = {
+    NET::Modal,
+    NET::Sticky,
+    NET::MaxVert,
+    NET::MaxHoriz,
+    NET::Shaded,
+    NET::SkipTaskbar,
+    NET::SkipPager,
+    NET::Hidden,
+    NET::FullScreen,
+    NET::KeepAbove,
+    NET::KeepBelow,
+    NET::DemandsAttention,
+    NET::Focused,
+    NET::SkipSwitcher,
+};
+
+const NET::Action kActions[] = {
+    NET::ActionMove,
+    NET::ActionResize,
+    NET::ActionMinimize,
+    NET::ActionShade,
+    NET::ActionStick,
+    NET::ActionMaxVert,
+    NET::ActionMaxHoriz,
+    NET::ActionFullScreen,
+    NET::ActionChangeDesktop,
+    NET::ActionClose,
+};
+
+// WM_STATE values, see ICCCM 4.1.3.1
+const quint32 kWithdrawnState = 0;
+const quint32 kIconicState = 3;
+
+// WM_HINTS flags bit, see ICCCM 4.1.2.4
+const quint32 kUrgencyHint = 1 << 8;
+
+// the properties requested for every window
+enum Property {
+  VisibleName = 0,
+  NetName,
+  Name,
+  Class,
+  Desktop,
+  State,
+  WindowType,
+  TransientFor,
+  MappingState,
+  Hints,
+  AllowedActions,
+  FrameExtents,
+  PropertyCount
+};
+
+struct WindowCookies {
+  xcb_get_geometry_cookie_t geometry;
+  xcb_translate_coordinates_cookie_t position;
+  xcb_get_property_cookie_t properties[PropertyCount];
+};
+
+using PropertyReply = QScopedPointer<xcb_get_property_reply_t, QScopedPointerPodDeleter>;
+
+xcb_get_property_reply_t* propertyReply(xcb_connection_t* connection, xcb_get_property_cookie_t cookie) {
+  xcb_generic_error_t* error = nullptr;
+  xcb_get_property_reply_t* reply = xcb_get_property_reply(connection, cookie, &error);
+  free(error);
+  if (reply && reply->type == XCB_ATOM_NONE) {
+    free(reply);
+    return nullptr;
+  }
+  return reply;
+}
+
+QByteArray propertyString(const PropertyReply& reply) {
+  if (!reply || reply->format != 8)
+    return QByteArray();
+  const char* data = static_cast<const char*>(xcb_get_property_value(reply.data()));
+  int length = xcb_get_property_value_length(reply.data());
+  // some clients include the terminating zero
+  while (length > 0 && data[length - 1] == '\0')
+    --length;
+  return QByteArray(data, length);
+}
+
+const quint32* propertyCardinals(const PropertyReply& reply, int& count) {
+  count = 0;
+  if (!reply || reply->format != 32)
+    return nullptr;
+  count = xcb_get_property_value_length(reply.data()) / 4;
+  return static_cast<const quint32*>(xcb_get_property_value(reply.data()));
+}
+}  // namespace
+
+OneG4X11WindowFetcher::OneG4X11WindowFetcher(xcb_connection_t* connection, WId rootWindow)
+    : mConnection(connection), mRootWindow(rootWindow), mAtoms(AtomCount, XCB_ATOM_NONE) {
+  static_assert(sizeof(kAtomNames) / sizeof(kAtomNames[0]) == AtomCount, "kAtomNames out of sync");
+  static_assert(sizeof(kWindowTypes) / sizeof(kWindowTypes[0]) == StateModal - TypeNormal, "kWindowTypes out of sync");
+  static_assert(sizeof(kStates) / sizeof(kStates[0]) == ActionMove - StateModal, "kStates out of sync");
+  static_assert(sizeof(kActions) / sizeof(kActions[0]) == AtomCount - ActionMove, "kActions out of sync");
+
+  // intern all atoms in one round trip
+  xcb_intern_atom_cookie_t cookies[AtomCount];
+  for (int i = 0; i < AtomCount; ++i)
+    cookies[i] = xcb_intern_atom(mConnection, false, strlen(kAtomNames[i]), kAtomNames[i]);
+
+  for (int i = 0; i < AtomCount; ++i) {
+    xcb_generic_error_t* error = nullptr;
+    xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(mConnection, cookies[i], &error);
+    if (reply)
+      mAtoms[i] = reply->atom;
+    free(reply);
+    free(error);
+  }
+
+  // same check KWindowInfo::isMinimized() does through KX11Extras::icccmCompliantMappingState()
+  mHiddenStateSupported = NETRootInfo(mConnection, NET::Supported).isSupported(NET::Hidden);
+}
+
+/************************************************
+
+ ************************************************/
+QHash<WId, OneG4X11WindowRecord> OneG4X11WindowFetcher::fetch(const QList<WId>& windows) const {
+  QHash<WId, OneG4X11WindowRecord> records;
+  if (windows.isEmpty())
+    return records;
+
+  struct Request {
+    xcb_atom_t property;
+    xcb_atom_t type;
+    quint32 length;  //!< in 32 bit units
+  };
+
+  const Request requests[PropertyCount] = {
+      {mAtoms[NetWmVisibleName], mAtoms[Utf8String], 1024},
+      {mAtoms[NetWmName], mAtoms[Utf8String], 1024},
+      {XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, 1024},
+      {XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 1024},
+      {mAtoms[NetWmDesktop], XCB_ATOM_CARDINAL, 1},
+      {mAtoms[NetWmState], XCB_ATOM_ATOM, 64},
+      {mAtoms[NetWmWindowType], XCB_ATOM_ATOM, 64},
+      {XCB_ATOM_WM_TRANSIENT_FOR, XCB_ATOM_WINDOW, 1},
+      {mAtoms[WmState], mAtoms[WmState], 2},
+      {XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, 9},
+      {mAtoms[NetWmAllowedActions], XCB_ATOM_ATOM, 64},
+      {mAtoms[NetFrameExtents], XCB_ATOM_CARDINAL, 4},
+  };
+
+  // send everything first...
+  QVector<WindowCookies> cookies(windows.count());
+  for (int i = 0; i < windows.count(); ++i) {
+    const xcb_window_t window = windows.at(i);
+    WindowCookies& c = cookies[i];
+    c.geometry = xcb_get_geometry(mConnection, window);
+    c.position = xcb_translate_coordinates(mConnection, window, mRootWindow, 0, 0);
+    for (int p = 0; p < PropertyCount; ++p)
+      c.properties[p] =
+          xcb_get_property(mConnection, false, window, requests[p].property, requests[p].type, 0, requests[p].length);
+  }
+
+  // ...then collect, every reply has to be read even for windows which turn out to be gone
+  records.reserve(windows.count());
+  for (int i = 0; i < windows.count(); ++i) {
+    const WindowCookies& c = cookies.at(i);
+
+    xcb_generic_error_t* error = nullptr;
+    QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter> geometry(
+        xcb_get_geometry_reply(mConnection, c.geometry, &error));
+    free(error);
+    error = nullptr;
+    QScopedPointer<xcb_translate_coordinates_reply_t, QScopedPointerPodDeleter> position(
+        xcb_translate_coordinates_reply(mConnection, c.position, &error));
+    free(error);
+
+    PropertyReply replies[PropertyCount];
+    for (int p = 0; p < PropertyCount; ++p)
+      replies[p].reset(propertyReply(mConnection, c.properties[p]));
+
+    if (!geometry || !position)
+      continue;
+
+    int count = 0;
+    const quint32* values = propertyCardinals(replies[MappingState], count);
+    const quint32 mappingState = count > 0 ? values[0] : kWithdrawnState;
+    // KWindowInfo::valid() treats withdrawn windows as invalid too
+    if (mappingState == kWithdrawnState)
+      continue;
+
+    OneG4X11WindowRecord record;
+
+    QByteArray title = propertyString(replies[VisibleName]);
+    if (title.isEmpty())
+      title = propertyString(replies[NetName]);
+    if (!title.isEmpty()) {
+      record.title = QString::fromUtf8(title);
+    } else if (replies[Name] && replies[Name]->type == mAtoms[Utf8String]) {
+      record.title = QString::fromUtf8(propertyString(replies[Name]));
+    } else {
+      record.title = QString::fromLatin1(propertyString(replies[Name]));
+    }
+
+    // WM_CLASS holds "instance\0class\0"
+    const QByteArray windowClass = propertyString(replies[Class]);
+    const int separator = windowClass.indexOf('\0');
+    if (separator >= 0)
+      record.windowClass = QString::fromUtf8(windowClass.mid(separator + 1));
+
+    values = propertyCardinals(replies[Desktop], count);
+    if (count > 0)
+      record.desktop = values[0] == 0xFFFFFFFF ? int(NET::OnAllDesktops) : int(values[0]) + 1;
+
+    values = propertyCardinals(replies[State], count);
+    record.state = states(values, count);
+
+    values = propertyCardinals(replies[TransientFor], count);
+    if (count > 0)
+      record.transientFor = values[0];
+
+    values = propertyCardinals(replies[WindowType], count);
+    if (count > 0) {
+      record.windowType = windowType(values, count);
+    } else {
+      // fallback recommended by the spec, as KWindowInfo::windowType() does
+      record.windowType = record.transientFor != 0 ? NET::Dialog : NET::Normal;
+    }
+
+    if (mappingState == kIconicState) {
+      if ((record.state & NET::Hidden) && !(record.state & NET::Shaded))
+        record.minimized = true;
+      else
+        record.minimized = !mHiddenStateSupported;
+    }
+
+    values = propertyCardinals(replies[Hints], count);
+    record.urgency = count > 0 && (values[0] & kUrgencyHint);
+
+    values = propertyCardinals(replies[AllowedActions], count);
+    record.allowedActions = actions(values, count);
+
+    record.geometry = QRect(position->dst_x, position->dst_y, geometry->width, geometry->height);
+
+    // _NET_FRAME_EXTENTS is left, right, top, bottom
+    values = propertyCardinals(replies[FrameExtents], count);
+    record.frameGeometry = record.geometry;
+    if (count >= 4)
+      record.frameGeometry.adjust(-int(values[0]), -int(values[2]), int(values[1]), int(values[3]));
+
+    records.insert(windows.at(i), record);
+  }
+
+  return records;
+}
+
+/************************************************
+
+ ************************************************/
+NET::WindowType OneG4X11WindowFetcher::windowType(const quint32* atoms, int count) const {
+  // the list is in order of preference, the first type we know wins
+  for (int i = 0; i < count; ++i) {
+    for (int t = TypeNormal; t < StateModal; ++t) {
+      if (atoms[i] == mAtoms.at(t))
+        return kWindowTypes[t - TypeNormal];
+    }
+  }
+  return NET::Unknown;
+}
+
+NET::States OneG4X11WindowFetcher::states(const quint32* atoms, int count) const {
+  NET::States result;
+  for (int i = 0; i < count; ++i) {
+    for (int s = StateModal; s < ActionMove; ++s) {
+      if (atoms[i] == mAtoms.at(s)) {
+        result |= kStates[s - StateModal];
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+NET::Actions OneG4X11WindowFetcher::actions(const quint32* atoms, int count) const {
+  NET::Actions result;
+  for (int i = 0; i < count; ++i) {
+    for (int a = ActionMove; a < AtomCount; ++a) {
+      if (atoms[i] == mAtoms.at(a)) {
+        result |= kActions[a - ActionMove];
+        break;
+      }
+    }
+  }
+  return result;
+}
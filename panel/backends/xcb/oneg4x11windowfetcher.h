@@ -0,0 +1,122 @@
+/* panel/backends/xcb/oneg4x11windowfetcher.h
+ * Window manager backend interfaces
+ */
+
+#ifndef ONEG4_X11_WINDOWFETCHER_H
+#define ONEG4_X11_WINDOWFETCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <QVector>
+#include <netwm_def.h>
+
+#include "../oneg4taskbartypes.h"
+
+struct xcb_connection_t;
+
+// Client side copy of the window properties the X11 backend cares about
+struct OneG4X11WindowRecord {
+  QString title;
+  QString windowClass;
+  NET::WindowType windowType = NET::Unknown;
+  NET::States state;
+  WId transientFor = 0;
+  int desktop = 0;
+  bool minimized = false;
+  bool urgency = false;
+  NET::Actions allowedActions;
+  QRect geometry;
+  QRect frameGeometry;
+};
+
+/*!
+ * \brief Reads OneG4X11WindowRecord of many windows at once.
+ *
+ * All xcb requests for all windows are queued before the first reply is collected, so
+ * fetching N windows costs about one round trip instead of a few per window as with
+ * KWindowInfo.
+ */
+class OneG4X11WindowFetcher {
+ public:
+  OneG4X11WindowFetcher(xcb_connection_t* connection, WId rootWindow);
+
+  // windows which no longer exist or are withdrawn are missing from the result
+  QHash<WId, OneG4X11WindowRecord> fetch(const QList<WId>& windows) const;
+
+ private:
+  enum Atom {
+    Utf8String = 0,
+    NetWmName,
+    NetWmVisibleName,
+    NetWmDesktop,
+    NetWmState,
+    NetWmWindowType,
+    NetWmAllowedActions,
+    NetFrameExtents,
+    WmState,
+
+    // keep in the order of kWindowTypes
+    TypeNormal,
+    TypeDesktop,
+    TypeDock,
+    TypeToolbar,
+    TypeMenu,
+    TypeDialog,
+    TypeUtility,
+    TypeSplash,
+    TypeDropdownMenu,
+    TypePopupMenu,
+    TypeTooltip,
+    TypeNotification,
+    TypeCombo,
+    TypeDnd,
+    TypeKdeOverride,
+    TypeKdeTopMenu,
+    TypeKdeOnScreenDisplay,
+    TypeKdeCriticalNotification,
+    TypeKdeAppletPopup,
+
+    // keep in the order of kStates
+    StateModal,
+    StateSticky,
+    StateMaxVert,
+    StateMaxHoriz,
+    StateShaded,
+    StateSkipTaskbar,
+    StateSkipPager,
+    StateHidden,
+    StateFullScreen,
+    StateAbove,
+    StateBelow,
+    StateDemandsAttention,
+    StateFocused,
+    StateKdeSkipSwitcher,
+
+    // keep in the order of kActions
+    ActionMove,
+    ActionResize,
+    ActionMinimize,
+    ActionShade,
+    ActionStick,
+    ActionMaxVert,
+    ActionMaxHoriz,
+    ActionFullScreen,
+    ActionChangeDesktop,
+    ActionClose,
+
+    AtomCount
+  };
+
+  NET::WindowType windowType(const quint32* atoms, int count) const;
+  NET::States states(const quint32* atoms, int count) const;
+  NET::Actions actions(const quint32* atoms, int count) const;
+
+  xcb_connection_t* mConnection;
+  WId mRootWindow;
+  QVector<quint32> mAtoms;
+  bool mHiddenStateSupported;
+};
+
+#endif  // ONEG4_X11_WINDOWFETCHER_H
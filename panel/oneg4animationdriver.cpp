@@ -0,0 +1,103 @@
+/* panel/oneg4animationdriver.cpp
+ * Main panel implementation, window management
+ */
+
+#include "oneg4animationdriver.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+
+#include <algorithm>
+
+/************************************************
+
+ ************************************************/
+OneG4AnimationDriver* OneG4AnimationDriver::instance() {
+  static OneG4AnimationDriver* driver = new OneG4AnimationDriver(qApp);
+  return driver;
+}
+
+/************************************************
+
+ ************************************************/
+OneG4AnimationDriver::OneG4AnimationDriver(QObject* parent) : QObject(parent) {
+  mTimer.setTimerType(Qt::PreciseTimer);
+  connect(&mTimer, &QTimer::timeout, this, &OneG4AnimationDriver::tick);
+  mClock.start();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4AnimationDriver::start(QObject* owner,
+                                 int key,
+                                 int duration,
+                                 const QEasingCurve& curve,
+                                 const std::function<void(qreal progress)>& update) {
+  stop(owner, key);
+  mAnimations.append({owner, key, mClock.elapsed(), std::max(1, duration), curve, update});
+
+  if (!mTimer.isActive()) {
+    // one tick per frame of the primary screen
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    mTimer.start(std::max(1, qRound(1000.0 / refreshRate)));
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4AnimationDriver::stop(QObject* owner, int key) {
+  mAnimations.removeIf([owner, key](const Animation& animation) {
+    return animation.owner == owner && animation.key == key;
+  });
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4AnimationDriver::isRunning(QObject* owner, int key) const {
+  return std::any_of(mAnimations.cbegin(), mAnimations.cend(), [owner, key](const Animation& animation) {
+    return animation.owner == owner && animation.key == key;
+  });
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4AnimationDriver::scheduleRepaint(QWidget* widget) {
+  if (!mRepaints.contains(widget))
+    mRepaints.append(widget);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4AnimationDriver::tick() {
+  const qint64 now = mClock.elapsed();
+
+  // updates may start or stop animations, those are seen on the next tick
+  const QVector<Animation> animations = mAnimations;
+  mAnimations.removeIf([now](const Animation& animation) {
+    return !animation.owner || now - animation.startTime >= animation.duration;
+  });
+
+  for (const Animation& animation : animations) {
+    if (!animation.owner)
+      continue;
+    const qreal progress = std::min<qreal>(1.0, qreal(now - animation.startTime) / animation.duration);
+    animation.update(animation.curve.valueForProgress(progress));
+  }
+
+  const QVector<QPointer<QWidget>> repaints = std::move(mRepaints);
+  mRepaints.clear();
+  for (const QPointer<QWidget>& widget : repaints) {
+    if (widget)
+      widget->update();
+  }
+
+  if (mAnimations.isEmpty())
+    mTimer.stop();
+}
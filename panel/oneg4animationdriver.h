@@ -0,0 +1,68 @@
+/* panel/oneg4animationdriver.h
+ * Main panel implementation, window management
+ */
+
+#ifndef ONEG4ANIMATIONDRIVER_H
+#define ONEG4ANIMATIONDRIVER_H
+
+#include <QEasingCurve>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+#include "oneg4panelglobals.h"
+
+class QWidget;
+
+/*!
+ * \brief Advances all the animations of the panel and its plugins from one timer.
+ *
+ * The timer ticks once per frame of the primary screen and only while something is animating.
+ * Animations repaint through scheduleRepaint(), so a widget touched by several animations is
+ * repainted once per frame.
+ */
+class ONEG4_PANEL_API OneG4AnimationDriver : public QObject {
+  Q_OBJECT
+
+ public:
+  static OneG4AnimationDriver* instance();
+
+  // Calls update with the eased progress, from 0 to 1, once per frame during duration ms.
+  // An animation is identified by its owner and key: starting it again replaces it, it is
+  // dropped with its owner.
+  void start(QObject* owner,
+             int key,
+             int duration,
+             const QEasingCurve& curve,
+             const std::function<void(qreal progress)>& update);
+  void stop(QObject* owner, int key);
+  bool isRunning(QObject* owner, int key) const;
+
+  // Repaints widget at the end of the current frame
+  void scheduleRepaint(QWidget* widget);
+
+ private:
+  explicit OneG4AnimationDriver(QObject* parent = nullptr);
+
+  void tick();
+
+  struct Animation {
+    QPointer<QObject> owner;
+    int key;
+    qint64 startTime;
+    int duration;
+    QEasingCurve curve;
+    std::function<void(qreal progress)> update;
+  };
+
+  QVector<Animation> mAnimations;
+  QVector<QPointer<QWidget>> mRepaints;
+  QElapsedTimer mClock;
+  QTimer mTimer;
+};
+
+#endif  // ONEG4ANIMATIONDRIVER_H
@@ -108,6 +108,7 @@ OneG4Panel::OneG4Panel(const QString& configGroup, OneG4::Settings* settings, QW
       mConfigGroup(configGroup),
       mPlugins{nullptr},
       mStandaloneWindows{new WindowNotifier},
+      mOverlapped(false),
       mPanelSize(0),
       mIconSize(0),
       mLineCount(0),
@@ -225,39 +226,22 @@ OneG4Panel::OneG4Panel(const QString& configGroup, OneG4::Settings* settings, QW
   OneG4PanelApplication* a = reinterpret_cast<OneG4PanelApplication*>(qApp);
   auto wmBackend = a->getWMBackend();
 
-  connect(wmBackend, &IOneG4AbstractWMInterface::windowAdded, this, [this] {
-    if (mHidable && mHideOnOverlap && !mHidden) {
+  // the backend tells us when a window starts or stops overlapping the panel
+  connect(wmBackend, &IOneG4AbstractWMInterface::areaOverlapChanged, this, [this](const QRect& area, bool overlapped) {
+    if (area != mWatchedArea)
+      return;
+
+    mOverlapped = overlapped;
+    if (!mHidable || !mHideOnOverlap)
+      return;
+
+    if (overlapped) {
       mShowDelayTimer.stop();
-      hidePanel();
-    }
-  });
-  connect(wmBackend, &IOneG4AbstractWMInterface::windowRemoved, this, [this] {
-    if (mHidable && mHideOnOverlap && mHidden && !isPanelOverlapped())
-      mShowDelayTimer.start();
-  });
-  connect(wmBackend, &IOneG4AbstractWMInterface::currentWorkspaceChanged, this, [this] {
-    if (mHidable && mHideOnOverlap) {
-      if (!mHidden) {
-        mShowDelayTimer.stop();
+      if (!mHidden)
         hidePanel();
-      }
-      else if (!isPanelOverlapped())
-        mShowDelayTimer.start();
-      else
-        mShowDelayTimer.stop();
     }
-  });
-  connect(wmBackend, &IOneG4AbstractWMInterface::windowPropertyChanged, this, [this](WId /* id */, int prop) {
-    if (mHidable && mHideOnOverlap &&
-        (prop == int(OneG4TaskBarWindowProperty::Geometry) || prop == int(OneG4TaskBarWindowProperty::State))) {
-      if (!mHidden) {
-        mShowDelayTimer.stop();
-        hidePanel();
-      }
-      else if (!isPanelOverlapped())
-        mShowDelayTimer.start();
-      else
-        mShowDelayTimer.stop();
+    else if (mHidden) {
+      mShowDelayTimer.start();
     }
   });
 }
@@ -376,6 +360,8 @@ void OneG4Panel::ensureVisible() {
  ************************************************/
 OneG4Panel::~OneG4Panel() {
   mLayout->setEnabled(false);
+  if (mWatchedArea.isValid())
+    reinterpret_cast<OneG4PanelApplication*>(qApp)->getWMBackend()->unwatchArea(mWatchedArea);
   delete mAnimation;
   delete mConfigDialog.data();
   // do not save settings because of "user deleted panel" functionality
@@ -533,6 +519,7 @@ void OneG4Panel::setPanelGeometry(bool animate) {
 
   if (!mHidden || !mGeometry.isValid())
     mGeometry = rect;
+  updateOverlapWatch();
   if (rect != geometry()) {
     setFixedSize(rect.size());
     if (animate) {
@@ -1240,12 +1227,32 @@ void OneG4Panel::userRequestForDeletion() {
 }
 
 bool OneG4Panel::isPanelOverlapped() const {
+  if (mWatchedArea.isValid() && mWatchedArea == mGeometry)
+    return mOverlapped;
+
   OneG4PanelApplication* a = reinterpret_cast<OneG4PanelApplication*>(qApp);
 
   QRect area = mGeometry;
   return a->getWMBackend()->isAreaOverlapped(area);
 }
 
+void OneG4Panel::updateOverlapWatch() {
+  const QRect area = mHidable && mHideOnOverlap ? mGeometry : QRect();
+  if (area == mWatchedArea)
+    return;
+
+  auto wmBackend = reinterpret_cast<OneG4PanelApplication*>(qApp)->getWMBackend();
+  if (mWatchedArea.isValid())
+    wmBackend->unwatchArea(mWatchedArea);
+
+  mWatchedArea = area;
+  mOverlapped = false;
+  if (mWatchedArea.isValid()) {
+    wmBackend->watchArea(mWatchedArea);
+    mOverlapped = wmBackend->isAreaOverlapped(mWatchedArea);
+  }
+}
+
 void OneG4Panel::showPanel(bool animate) {
   if (mHidable) {
     mHideTimer.stop();
@@ -513,6 +513,18 @@ class ONEG4_PANEL_API OneG4Panel : public QFrame, public IOneG4Panel {
    * calculatePopupWindowPos()
    */
   QRect mGeometry;
+  /**
+   * @brief The area registered with IOneG4AbstractWMInterface::watchArea(),
+   * i.e. mGeometry while hiding on overlap is enabled, otherwise a null rect.
+   *
+   * \sa mOverlapped, updateOverlapWatch()
+   */
+  QRect mWatchedArea;
+  /**
+   * @brief Whether a window overlaps mWatchedArea, kept up to date by the
+   * IOneG4AbstractWMInterface::areaOverlapChanged() signal.
+   */
+  bool mOverlapped;
   /**
    * @brief Stores the size of the panel, i.e. the height of a horizontal
    * panel or the width of a vertical panel in pixels. If the panel is
@@ -685,6 +697,11 @@ class ONEG4_PANEL_API OneG4Panel : public QFrame, public IOneG4Panel {
    * @brief Checks if the panel overlaps a window.
    */
   bool isPanelOverlapped() const;
+  /**
+   * @brief Registers mGeometry with the window manager backend for overlap
+   * tracking, or drops the registration if hiding on overlap is disabled.
+   */
+  void updateOverlapWatch();
 
   // settings should be kept private for security
   OneG4::Settings* settings() const { return mSettings; }
@@ -10,6 +10,7 @@
 
 #include <QCommandLineParser>
 #include <QScreen>
+#include <QTimer>
 #include <QUuid>
 #include <QWindow>
 #include <QtDebug>
@@ -22,6 +23,8 @@
 #include <QCoreApplication>
 
 #include "backends/oneg4dummywmbackend.h"
+#include "backends/oneg4replaywmbackend.h"
+#include "backends/oneg4wmrecorder.h"
 
 static inline QString getBackendFilePath(QString name) {
   // if we do not have a full library name like libwmbackend_xcb.so
@@ -103,6 +106,24 @@ IOneG4Panel::Position OneG4PanelApplicationPrivate::computeNewPanelPosition(cons
 }
 
 void OneG4PanelApplicationPrivate::loadBackend() {
+  const QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+
+  // a trace written through ONEG4PANEL_WM_RECORD replaces the window manager
+  const QString replayFile = env.value(QStringLiteral("ONEG4PANEL_WM_REPLAY"));
+  if (!replayFile.isEmpty()) {
+    bool ok = false;
+    const qreal speed = env.value(QStringLiteral("ONEG4PANEL_WM_REPLAY_SPEED")).toDouble(&ok);
+    OneG4ReplayWMBackend* replay = new OneG4ReplayWMBackend(replayFile, ok ? speed : 1.0, q_ptr);
+    if (replay->isValid()) {
+      qDebug() << "\nPanel backend: replay of" << replayFile << "\n";
+      mWMBackend = replay;
+      // the panels are created first, the records are played once the event loop runs
+      QTimer::singleShot(0, replay, &OneG4ReplayWMBackend::start);
+      return;
+    }
+    delete replay;
+  }
+
   // only X11/XCB backend is supported
   const QString preferredBackend = QStringLiteral("xcb");
 
@@ -144,6 +165,10 @@ void OneG4PanelApplicationPrivate::loadBackend() {
   }
 
   mWMBackend->setParent(q_ptr);
+
+  const QString recordFile = env.value(QStringLiteral("ONEG4PANEL_WM_RECORD"));
+  if (!recordFile.isEmpty())
+    new OneG4WMRecorder(mWMBackend, recordFile, mWMBackend);
 }
 
 OneG4PanelApplication::OneG4PanelApplication(int& argc, char** argv)
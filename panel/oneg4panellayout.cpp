@@ -6,7 +6,6 @@
 #include <QSize>
 #include <QPoint>
 #include <QRect>
-#include <QVariantAnimation>
 #include <QEasingCurve>
 #include <QLayoutItem>
 #include <QLayout>
@@ -16,6 +15,7 @@
 #include <algorithm>
 
 #include "oneg4panellayout.h"
+#include "oneg4animationdriver.h"
 #include "plugin.h"
 #include "oneg4panellimits.h"
 #include "ioneg4panelplugin.h"
@@ -24,20 +24,8 @@
 
 namespace {
 constexpr int kAnimationDurationMs = 250;
-}
-
-class ItemMoveAnimation : public QVariantAnimation {
- public:
-  explicit ItemMoveAnimation(QLayoutItem* item) : mItem(item) {
-    setEasingCurve(QEasingCurve::OutBack);
-    setDuration(kAnimationDurationMs);
-  }
-
-  void updateCurrentValue(const QVariant& current) override { mItem->setGeometry(current.toRect()); }
-
- private:
-  QLayoutItem* mItem;
-};
+constexpr int kItemMoveAnimation = 0;
+}  // namespace
 
 struct LayoutItemInfo {
   LayoutItemInfo(QLayoutItem* layoutItem = nullptr);
@@ -507,10 +495,17 @@ void OneG4PanelLayout::setGeometry(const QRect& geometry) {
 void OneG4PanelLayout::setItemGeometry(QLayoutItem* item, const QRect& geometry, bool withAnimation) {
   Plugin* plugin = qobject_cast<Plugin*>(item->widget());
   if (withAnimation && plugin) {
-    auto* animation = new ItemMoveAnimation(item);
-    animation->setStartValue(item->geometry());
-    animation->setEndValue(geometry);
-    animation->start(QAbstractAnimation::DeleteWhenStopped);
+    const QRect start = item->geometry();
+    auto interpolate = [](int from, int to, qreal progress) { return from + qRound((to - from) * progress); };
+    // keyed by the plugin, a new move replaces the running one
+    OneG4AnimationDriver::instance()->start(
+        plugin, kItemMoveAnimation, kAnimationDurationMs, QEasingCurve::OutBack,
+        [item, start, geometry, interpolate](qreal progress) {
+          item->setGeometry(QRect(interpolate(start.x(), geometry.x(), progress),
+                                  interpolate(start.y(), geometry.y(), progress),
+                                  interpolate(start.width(), geometry.width(), progress),
+                                  interpolate(start.height(), geometry.height(), progress)));
+        });
   }
   else {
     item->setGeometry(geometry);
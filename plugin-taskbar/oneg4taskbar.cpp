@@ -7,7 +7,6 @@
 #include <QApplication>
 #include <QDebug>
 #include <QSignalMapper>
-#include <QToolButton>
 #include <QSettings>
 #include <QList>
 #include <QMimeData>
@@ -23,6 +22,8 @@
 #include <OneG4/GridLayout.h>
 
 #include "oneg4taskgroup.h"
+#include "oneg4taskiconcache.h"
+#include "oneg4tasklistview.h"
 #include "../panel/pluginsettings.h"
 
 #include "../panel/backends/ioneg4abstractwmiface.h"
@@ -30,11 +31,27 @@
 
 using namespace OneG4;
 
+namespace {
+const int kButtonPoolSize = 16;
+// wheel steps further apart than this start a new most recently used cycle
+const int kRecentCycleTimeout = 1000;
+}  // namespace
+
 /************************************************
 
 ************************************************/
 OneG4TaskBar::OneG4TaskBar(IOneG4PanelPlugin* plugin, QWidget* parent)
     : QFrame(parent),
+      mActiveWindow(0),
+      mCurrentDesktop(0),
+      mFilterScreen(nullptr),
+      mRefreshingVisibility(false),
+      mIconGeometriesQueued(false),
+      mVisibleGroupsValid(false),
+      mRecentGroupPos(0),
+      mSettingsQueued(false),
+      mSettingsApplied(false),
+      mListView(nullptr),
       mSignalMapper(new QSignalMapper(this)),
       mButtonStyle(Qt::ToolButtonTextBesideIcon),
       mButtonWidth(220),
@@ -50,6 +67,7 @@ OneG4TaskBar::OneG4TaskBar(IOneG4PanelPlugin* plugin, QWidget* parent)
       mShowGroupOnHover(true),
       mUngroupedNextToExisting(false),
       mIconByClass(false),
+      mPaintedTaskList(false),
       mWheelEventsAction(1),
       mWheelDeltaThreshold(300),
       mButtonOpacity(1.0),
@@ -57,7 +75,12 @@ OneG4TaskBar::OneG4TaskBar(IOneG4PanelPlugin* plugin, QWidget* parent)
       mPlugin(plugin),
       mPlaceHolder(new QWidget(this)),
       mStyle(new LeftAlignedTextStyle()),
-      mBackend(nullptr) {
+      mBackend(nullptr),
+      mUrgentProbe(nullptr),
+      mUrgentPaletteValid(false),
+      mUrgencyBlink(false),
+      mUrgencyBlinkOff(false),
+      mUrgencyBlinkTimer(new QTimer(this)) {
   setStyle(mStyle);
   mLayout = new OneG4::GridLayout(this);
   setLayout(mLayout);
@@ -70,18 +93,28 @@ OneG4TaskBar::OneG4TaskBar(IOneG4PanelPlugin* plugin, QWidget* parent)
   mPlaceHolder->setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
   mLayout->addWidget(mPlaceHolder);
 
+  mUrgencyBlinkTimer->setInterval(500);
+  connect(mUrgencyBlinkTimer, &QTimer::timeout, this, &OneG4TaskBar::blinkUrgentButtons);
+
   // Get backend
   OneG4PanelApplication* a = static_cast<OneG4PanelApplication*>(qApp);
   mBackend = a->getWMBackend();
 
-  QTimer::singleShot(0, this, &OneG4TaskBar::settingsChanged);
+  settingsChanged();
   setAcceptDrops(true);
 
   connect(mSignalMapper, &QSignalMapper::mappedInt, this, &OneG4TaskBar::activateTask);
 
-  connect(mBackend, &IOneG4AbstractWMInterface::windowPropertyChanged, this, &OneG4TaskBar::onWindowChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::windowPropertiesChanged, this, &OneG4TaskBar::onWindowChanged);
   connect(mBackend, &IOneG4AbstractWMInterface::windowAdded, this, &OneG4TaskBar::onWindowAdded);
   connect(mBackend, &IOneG4AbstractWMInterface::windowRemoved, this, &OneG4TaskBar::onWindowRemoved);
+  connect(mBackend, &IOneG4AbstractWMInterface::windowScreenChanged, this, &OneG4TaskBar::onWindowScreenChanged);
+  // dispatched here once instead of being connected to every group
+  connect(mBackend, &IOneG4AbstractWMInterface::activeWindowChanged, this, &OneG4TaskBar::onActiveWindowChanged);
+  connect(mBackend, &IOneG4AbstractWMInterface::currentWorkspaceChanged, this, &OneG4TaskBar::onDesktopChanged);
+
+  mActiveWindow = mBackend->getActiveWindow();
+  mCurrentDesktop = mBackend->getCurrentWorkspace();
 
   // Consider already fetched windows
   const auto initialWindows = mBackend->getCurrentWindows();
@@ -181,6 +214,27 @@ void OneG4TaskBar::buttonMove(OneG4TaskGroup* dst, OneG4TaskGroup* src, QPoint c
     return;
 
   mLayout->moveItem(src_index, dst_index, true);
+  invalidateVisibleGroups();
+  // only the classes of the moved groups can get another last group
+  refreshLastGroupOfClass(windowClass(src->windowId()));
+  if (nullptr != dst)
+    refreshLastGroupOfClass(windowClass(dst->windowId()));
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::refreshLastGroupOfClass(const QString& window_class, int from) {
+  if (from < 0 || mLayout->count() <= from)
+    from = mLayout->count() - 1;
+  for (int i = from; 0 <= i; --i) {
+    OneG4TaskGroup* group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
+    if (nullptr != group && windowClass(group->windowId()) == window_class) {
+      mLastGroupOfClass.insert(window_class, group);
+      return;
+    }
+  }
+  mLastGroupOfClass.remove(window_class);
 }
 
 /************************************************
@@ -191,24 +245,153 @@ void OneG4TaskBar::groupBecomeEmptySlot() {
   OneG4TaskGroup* const group = qobject_cast<OneG4TaskGroup*>(sender());
   Q_ASSERT(group);
 
-  for (auto i = mKnownWindows.begin(); mKnownWindows.end() != i;) {
-    if (group == *i)
-      i = mKnownWindows.erase(i);
-    else
-      ++i;
-  }
+  // the windows of the group were removed from or reassigned in mKnownWindows already
+  if (mGroups.value(group->groupName()) == group)
+    mGroups.remove(group->groupName());
+  const int index = mLayout->indexOf(group);
   mLayout->removeWidget(group);
+  for (auto it = mLastGroupOfClass.begin(); it != mLastGroupOfClass.end(); ++it) {
+    if (*it == group) {
+      // the groups before it keep their positions
+      const QString window_class = it.key();
+      refreshLastGroupOfClass(window_class, index - 1);
+      break;
+    }
+  }
+  invalidateVisibleGroups();
   group->deleteLater();
 }
 
+/************************************************
+
+ ************************************************/
+OneG4TaskButton* OneG4TaskBar::takeButton(WId window, QWidget* parent) {
+  if (mButtonPool.isEmpty())
+    return new OneG4TaskButton(window, this, parent);
+
+  OneG4TaskButton* button = mButtonPool.takeLast();
+  button->setParent(parent);
+  button->resetWindow(window);
+  return button;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::recycleButton(OneG4TaskButton* button) {
+  // enough to absorb a burst of short lived windows, the rest is freed
+  if (mButtonPool.count() >= kButtonPoolSize) {
+    button->deleteLater();
+    return;
+  }
+
+  button->hide();
+  button->releaseWindow();
+  button->setParent(this);
+  mButtonPool.append(button);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::removeAllGroups() {
+  for (int i = mLayout->count() - 1; 0 <= i; --i) {
+    OneG4TaskGroup* group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
+    if (nullptr != group) {
+      mLayout->takeAt(i);
+      group->deleteLater();
+    }
+  }
+  mKnownWindows.clear();
+  mGroups.clear();
+  mLastGroupOfClass.clear();
+  invalidateVisibleGroups();
+}
+
+/************************************************
+
+ ************************************************/
+const QVector<OneG4TaskGroup*>& OneG4TaskBar::visibleGroups() {
+  if (mVisibleGroupsValid)
+    return mVisibleGroups;
+
+  mVisibleGroups.clear();
+  mVisibleGroupIndex.clear();
+  for (int i = 0; i < mLayout->count(); ++i) {
+    OneG4TaskGroup* group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
+    if (group && group->isVisibleTo(this)) {
+      mVisibleGroupIndex.insert(group, mVisibleGroups.count());
+      mVisibleGroups.append(group);
+    }
+  }
+  mVisibleGroupsValid = true;
+  return mVisibleGroups;
+}
+
+/************************************************
+
+ ************************************************/
+const QString& OneG4TaskBar::windowClass(WId window) {
+  auto i = mWindowClasses.find(window);
+  if (mWindowClasses.end() == i)
+    i = mWindowClasses.insert(window, mBackend->getWindowClass(window));
+  return *i;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::setPaintedTaskList(bool painted) {
+  if (painted == (mListView != nullptr))
+    return;
+
+  if (painted) {
+    removeAllGroups();
+    mListView = new OneG4TaskListView(this);
+    mLayout->addWidget(mListView);
+  }
+  else {
+    mLayout->removeWidget(mListView);
+    delete mListView;
+    mListView = nullptr;
+  }
+  realign();
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4TaskBar::isExcluded(WId window) {
+  if (mExcluded.isEmpty())
+    return false;
+  return mExcluded.matchesClass(windowClass(window)) ||
+         (mExcluded.matchesTitles() && mExcluded.matchesTitle(mBackend->getWindowTitle(window)));
+}
+
 /************************************************
 
  ************************************************/
 void OneG4TaskBar::addWindow(WId window) {
-  if (mExcludedList.contains(mBackend->getWindowClass(window), Qt::CaseInsensitive))
+  if (isExcluded(window)) {
+    // e.g. the class changed to an excluded one
+    auto const pos = mKnownWindows.find(window);
+    if (mKnownWindows.end() != pos)
+      removeWindow(pos);
+    mWindowClasses.remove(window);
+    return;
+  }
+  const QString window_class = windowClass(window);
+  // the group asks for the cached visibility as soon as the button is added
+  updateWindowFilter(window, filterProperties());
+
+  if (mListView) {
+    mListView->addWindow(window);
+    queueIconGeometries();
     return;
+  }
+
   // If grouping disabled group behaves like regular button
-  const QString group_id = mGroupingEnabled ? mBackend->getWindowClass(window) : QString::number(window);
+  const QString group_id = mGroupingEnabled ? window_class : QString::number(window);
 
   OneG4TaskGroup* group = nullptr;
   auto i_group = mKnownWindows.find(window);
@@ -220,50 +403,39 @@ void OneG4TaskBar::addWindow(WId window) {
   }
 
   // check if window belongs to some existing group
-  if (!group && mGroupingEnabled) {
-    for (auto i = mKnownWindows.cbegin(), i_e = mKnownWindows.cend(); i != i_e; ++i) {
-      if ((*i)->groupName() == group_id) {
-        group = *i;
-        break;
-      }
-    }
-  }
+  if (!group && mGroupingEnabled)
+    group = mGroups.value(group_id, nullptr);
 
   if (!group) {
     group = new OneG4TaskGroup(group_id, window, this);
+    mGroups.insert(group_id, group);
     connect(group, &OneG4TaskGroup::groupBecomeEmpty, this, &OneG4TaskBar::groupBecomeEmptySlot);
     connect(group, &OneG4TaskGroup::visibilityChanged, this, &OneG4TaskBar::refreshPlaceholderVisibility);
+    connect(group, &OneG4TaskGroup::visibilityChanged, this, &OneG4TaskBar::invalidateVisibleGroups);
     connect(group, &OneG4TaskGroup::popupShown, this, &OneG4TaskBar::popupShown);
     connect(group, &OneG4TaskButton::dragging, this, [this](QObject* dragSource, QPoint const& pos) {
       buttonMove(qobject_cast<OneG4TaskGroup*>(sender()), qobject_cast<OneG4TaskGroup*>(dragSource), pos);
     });
     mLayout->addWidget(group);
+    invalidateVisibleGroups();
     group->setToolButtonsStyle(mButtonStyle);
     group->setButtonOpacity(mButtonOpacity);
     group->setPopupOpacity(mGroupPopupOpacity);
 
-    if (mUngroupedNextToExisting) {
-      const QString window_class = mBackend->getWindowClass(window);
-      int src_index = mLayout->count() - 1;
-      int dst_index = src_index;
-      for (int i = mLayout->count() - 2; 0 <= i; --i) {
-        OneG4TaskGroup* current_group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
-        if (nullptr != current_group) {
-          const QString current_class = mBackend->getWindowClass(current_group->groupName().toULong());
-          if (current_class == window_class) {
-            dst_index = i + 1;
-            break;
-          }
-        }
-      }
-
-      if (dst_index != src_index) {
+    OneG4TaskGroup* const last_of_class = mLastGroupOfClass.value(window_class, nullptr);
+    if (mUngroupedNextToExisting && nullptr != last_of_class) {
+      const int src_index = mLayout->count() - 1;
+      const int dst_index = mLayout->indexOf(last_of_class) + 1;
+      if (0 < dst_index && dst_index != src_index) {
         mLayout->moveItem(src_index, dst_index, false);
       }
     }
+    // either appended or placed right behind the previous last one
+    mLastGroupOfClass.insert(window_class, group);
   }
   mKnownWindows[window] = group;
   group->addWindow(window);
+  queueIconGeometries();
 }
 
 /************************************************
@@ -273,6 +445,8 @@ auto OneG4TaskBar::removeWindow(windowMap_t::iterator pos) -> windowMap_t::itera
   WId const window = pos.key();
   OneG4TaskGroup* const group = *pos;
   auto ret = mKnownWindows.erase(pos);
+  mWindowFilters.remove(window);
+  mWindowClasses.remove(window);
   group->onWindowRemoved(window);
   return ret;
 }
@@ -280,19 +454,173 @@ auto OneG4TaskBar::removeWindow(windowMap_t::iterator pos) -> windowMap_t::itera
 /************************************************
 
  ************************************************/
-void OneG4TaskBar::onWindowChanged(WId window, int prop) {
+bool OneG4TaskBar::isWindowVisible(WId window) const {
+  auto const pos = mWindowFilters.constFind(window);
+  return mWindowFilters.cend() == pos || pos->visible;
+}
+
+/************************************************
+
+ ************************************************/
+int OneG4TaskBar::filterProperties() const {
+  int props = 0;
+  if (mShowOnlyOneDesktopTasks)
+    props |= windowPropertyMask(OneG4TaskBarWindowProperty::Workspace);
+  if (mShowOnlyCurrentScreenTasks)
+    props |= windowPropertyMask(OneG4TaskBarWindowProperty::Geometry);
+  if (mShowOnlyMinimizedTasks)
+    props |= windowPropertyMask(OneG4TaskBarWindowProperty::State);
+  return props;
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4TaskBar::acceptsWindow(const WindowFilter& filter) const {
+  if (mShowOnlyOneDesktopTasks) {
+    const int desktop = mShowDesktopNum == 0 ? mCurrentDesktop : mShowDesktopNum;
+    if (filter.desktop != desktop && filter.desktop != mBackend->onAllWorkspacesEnum())
+      return false;
+  }
+  if (mShowOnlyCurrentScreenTasks && !filter.onScreen)
+    return false;
+  if (mShowOnlyMinimizedTasks && !filter.minimized)
+    return false;
+  return true;
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4TaskBar::updateWindowFilter(WId window, int props) {
+  // inputs of disabled filters are not tracked, they are re-read once the filter gets enabled
+  WindowFilter& filter = mWindowFilters[window];
+  if (props & windowPropertyMask(OneG4TaskBarWindowProperty::Workspace))
+    filter.desktop = mBackend->getWindowWorkspace(window);
+  if (props & windowPropertyMask(OneG4TaskBarWindowProperty::Geometry))
+    filter.onScreen = mBackend->isWindowOnScreen(screen(), window);
+  if (props & windowPropertyMask(OneG4TaskBarWindowProperty::State))
+    filter.minimized = mBackend->getWindowState(window) == OneG4TaskBarWindowState::Minimized;
+
+  const bool visible = acceptsWindow(filter);
+  if (visible == filter.visible)
+    return false;
+  filter.visible = visible;
+  return true;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::refreshWindowFilters(int props) {
+  if (mListView) {
+    bool changed = false;
+    const auto windows = mWindowFilters.keys();
+    for (WId window : windows)
+      changed = updateWindowFilter(window, props) || changed;
+    if (changed)
+      mListView->refreshVisibility();
+    return;
+  }
+
+  QSet<OneG4TaskGroup*> affected;
+  for (auto i = mKnownWindows.cbegin(), i_e = mKnownWindows.cend(); i != i_e; ++i) {
+    if (updateWindowFilter(i.key(), props))
+      affected.insert(i.value());
+  }
+  refreshGroupsVisibility(affected);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::refreshGroupsVisibility(const QSet<OneG4TaskGroup*>& groups) {
+  if (groups.isEmpty())
+    return;
+
+  // one layout pass and one placeholder check for the whole batch
+  setUpdatesEnabled(false);
+  mLayout->setEnabled(false);
+  mRefreshingVisibility = true;
+  for (OneG4TaskGroup* group : groups)
+    group->refreshVisibility();
+  mRefreshingVisibility = false;
+  mLayout->setEnabled(true);
+  setUpdatesEnabled(true);
+  refreshPlaceholderVisibility();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::onWindowChanged(WId window, int props) {
+  // what the exclusion list looks at
+  const int matchedProps = windowPropertyMask(OneG4TaskBarWindowProperty::Title) |
+                           windowPropertyMask(OneG4TaskBarWindowProperty::WindowClass);
   auto i = mKnownWindows.find(window);
-  if (mKnownWindows.end() != i) {
-    if (!(*i)->onWindowChanged(window, OneG4TaskBarWindowProperty(prop))) {
+  if (mListView ? mListView->contains(window) : mKnownWindows.end() != i) {
+    // once per window, not once per button showing it
+    if (props & windowPropertyMask(OneG4TaskBarWindowProperty::Icon))
+      OneG4TaskIconCache::instance()->invalidate(mBackend, window);
+    if (props & windowPropertyMask(OneG4TaskBarWindowProperty::WindowClass)) {
+      const QString old_class = mWindowClasses.take(window);
+      // an ungrouped button keeps its group, which may now be the last of either class
+      if (!mListView && !mGroupingEnabled) {
+        if (mLastGroupOfClass.value(old_class, nullptr) == *i)
+          refreshLastGroupOfClass(old_class);
+        refreshLastGroupOfClass(windowClass(window));
+      }
+    }
+    if ((props & matchedProps) && isExcluded(window)) {
+      onWindowRemoved(window);
+      return;
+    }
+
+    // moves within a screen do not matter, crossing one comes through onWindowScreenChanged()
+    const int filterProps = props & filterProperties() & ~windowPropertyMask(OneG4TaskBarWindowProperty::Geometry);
+    const bool visibilityChanged = filterProps && updateWindowFilter(window, filterProps);
+
+    if (mListView) {
+      mListView->onWindowChanged(window, props);
+      if (visibilityChanged)
+        mListView->refreshVisibility();
+    }
+    else if (!(*i)->onWindowChanged(window, props)) {
       // window is removed from a group because of class change, so we should add it again
       addWindow(window);
     }
+    else if (visibilityChanged) {
+      (*i)->refreshVisibility();
+    }
+  }
+  else if ((props & matchedProps) && !mExcluded.isEmpty()) {
+    // the backend only reports the windows it accepts, this one was excluded here
+    mWindowClasses.remove(window);
+    addWindow(window);
   }
 }
 
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::onWindowScreenChanged(WId window) {
+  if (!mShowOnlyCurrentScreenTasks)
+    return;
+
+  if (mListView) {
+    if (mListView->contains(window) &&
+        updateWindowFilter(window, windowPropertyMask(OneG4TaskBarWindowProperty::Geometry)))
+      mListView->refreshVisibility();
+    return;
+  }
+
+  auto i = mKnownWindows.find(window);
+  if (mKnownWindows.end() != i && updateWindowFilter(window, windowPropertyMask(OneG4TaskBarWindowProperty::Geometry)))
+    (*i)->refreshVisibility();
+}
+
 void OneG4TaskBar::onWindowAdded(WId window) {
-  auto const pos = mKnownWindows.find(window);
-  if (mKnownWindows.end() == pos)
+  if (mListView ? !mListView->contains(window) : !mKnownWindows.contains(window))
     addWindow(window);
 }
 
@@ -300,10 +628,72 @@ void OneG4TaskBar::onWindowAdded(WId window) {
 
  ************************************************/
 void OneG4TaskBar::onWindowRemoved(WId window) {
+  if (mListView) {
+    mWindowFilters.remove(window);
+    mWindowClasses.remove(window);
+    mListView->removeWindow(window);
+    return;
+  }
+
   auto const pos = mKnownWindows.find(window);
   if (mKnownWindows.end() != pos) {
     removeWindow(pos);
   }
+  else {
+    // excluded windows are looked up too
+    mWindowClasses.remove(window);
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::onActiveWindowChanged(WId window) {
+  const WId previousWindow = mActiveWindow;
+  OneG4TaskGroup* previousGroup = mKnownWindows.value(previousWindow, nullptr);
+  OneG4TaskGroup* group = mKnownWindows.value(window, nullptr);
+  mActiveWindow = window;
+
+  if (mListView) {
+    mListView->onActiveWindowChanged(window);
+    return;
+  }
+
+  if (previousGroup && previousGroup != group)
+    previousGroup->onActiveWindowChanged(window, previousWindow);
+  if (group)
+    group->onActiveWindowChanged(window, previousWindow);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::onDesktopChanged(int desktop) {
+  const int previousDesktop = mCurrentDesktop;
+  mCurrentDesktop = desktop;
+
+  // only the "current desktop" filter depends on it
+  if (!mShowOnlyOneDesktopTasks || mShowDesktopNum != 0 || previousDesktop == desktop)
+    return;
+
+  // windows on all desktops stay put, only windows on the old or new desktop can flip; their
+  // desktops are cached, so no backend query is needed
+  QSet<OneG4TaskGroup*> affected;
+  bool changed = false;
+  for (auto i = mWindowFilters.begin(), i_e = mWindowFilters.end(); i != i_e; ++i) {
+    if (i->desktop != previousDesktop && i->desktop != desktop)
+      continue;
+    const bool visible = acceptsWindow(*i);
+    if (visible == i->visible)
+      continue;
+    i->visible = visible;
+    changed = true;
+    if (OneG4TaskGroup* group = mKnownWindows.value(i.key(), nullptr))
+      affected.insert(group);
+  }
+  if (mListView && changed)
+    mListView->refreshVisibility();
+  refreshGroupsVisibility(affected);
 }
 
 /************************************************
@@ -320,8 +710,12 @@ void OneG4TaskBar::refreshButtonRotation() {
 
  ************************************************/
 void OneG4TaskBar::refreshPlaceholderVisibility() {
+  // done once at the end of a batch
+  if (mRefreshingVisibility)
+    return;
+
   // if no visible group button show placeholder widget
-  bool haveVisibleWindow = false;
+  bool haveVisibleWindow = mListView && mListView->hasVisibleTasks();
   for (auto i = mKnownWindows.cbegin(), i_e = mKnownWindows.cend(); i_e != i; ++i) {
     if ((*i)->isVisibleTo(this)) {
       haveVisibleWindow = true;
@@ -337,6 +731,94 @@ void OneG4TaskBar::refreshPlaceholderVisibility() {
   }
 }
 
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::queueIconGeometries() {
+  if (mIconGeometriesQueued)
+    return;
+
+  mIconGeometriesQueued = true;
+  QTimer::singleShot(0, this, &OneG4TaskBar::publishIconGeometries);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::publishIconGeometries() {
+  mIconGeometriesQueued = false;
+
+  // the backend diffs these against what it wrote before and sends only the changes
+  QHash<WId, QRect> geometries;
+  if (mListView)
+    mListView->refreshIconsGeometry(geometries);
+  for (int i = 0; i < mLayout->count(); ++i) {
+    OneG4TaskGroup* group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
+    if (group)
+      group->refreshIconsGeometry(geometries);
+  }
+  mBackend->refreshIconGeometries(geometries);
+}
+
+/************************************************
+
+ ************************************************/
+const QPalette& OneG4TaskBar::urgentPalette() {
+  if (!mUrgentPaletteValid) {
+    mUrgentPaletteValid = true;
+    if (!mUrgentProbe) {
+      // a window-less task button under the taskbar, so rules on the class and the taskbar match it
+      mUrgentProbe = new OneG4TaskButton(0, this, this);
+      mUrgentProbe->hide();
+    }
+
+    // themes style urgent buttons through the "urgent" property, only the colours are taken over
+    mUrgentProbe->setProperty("urgent", false);
+    mUrgentProbe->style()->unpolish(mUrgentProbe);
+    mUrgentProbe->style()->polish(mUrgentProbe);
+    const QColor normalButton = mUrgentProbe->palette().color(QPalette::Button);
+    mUrgentProbe->setProperty("urgent", true);
+    mUrgentProbe->style()->unpolish(mUrgentProbe);
+    mUrgentProbe->style()->polish(mUrgentProbe);
+    mUrgentPalette = mUrgentProbe->palette();
+
+    if (mUrgentPalette.color(QPalette::Button) == normalButton) {
+      // the theme does not style urgency, the highlight still makes it visible
+      mUrgentPalette.setColor(QPalette::Button, palette().color(QPalette::Highlight));
+      mUrgentPalette.setColor(QPalette::ButtonText, palette().color(QPalette::HighlightedText));
+    }
+  }
+  return mUrgentPalette;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::startUrgencyBlink() {
+  if (mUrgencyBlink && !mUrgencyBlinkTimer->isActive())
+    mUrgencyBlinkTimer->start();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::blinkUrgentButtons() {
+  // a disabled blink ends on the urgent phase
+  mUrgencyBlinkOff = mUrgencyBlink && !mUrgencyBlinkOff;
+
+  bool urgent = mListView && mListView->repaintUrgentTasks();
+  for (int i = 0; i < mLayout->count(); ++i) {
+    OneG4TaskGroup* group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
+    if (group && group->repaintUrgentButtons())
+      urgent = true;
+  }
+
+  if (!urgent || !mUrgencyBlink) {
+    mUrgencyBlinkTimer->stop();
+    mUrgencyBlinkOff = false;
+  }
+}
+
 /************************************************
 
  ************************************************/
@@ -351,13 +833,10 @@ void OneG4TaskBar::setButtonStyle(Qt::ToolButtonStyle buttonStyle) {
  *
  ************************************************/
 void OneG4TaskBar::refreshOpacities() {
-  QSet<OneG4TaskGroup*> processed;
-  for (auto it = mKnownWindows.cbegin(); it != mKnownWindows.cend(); ++it) {
-    OneG4TaskGroup* group = it.value();
-    if (!group || processed.contains(group))
-      continue;
+  if (mListView)
+    mListView->setOpacity(mButtonOpacity);
 
-    processed.insert(group);
+  for (OneG4TaskGroup* group : std::as_const(mGroups)) {
     group->setButtonOpacity(mButtonOpacity);
     group->setPopupOpacity(mGroupPopupOpacity);
   }
@@ -367,6 +846,22 @@ void OneG4TaskBar::refreshOpacities() {
 
  ************************************************/
 void OneG4TaskBar::settingsChanged() {
+  // the configuration dialog writes its keys one by one, each write lands here
+  if (mSettingsQueued)
+    return;
+  mSettingsQueued = true;
+  QTimer::singleShot(0, this, &OneG4TaskBar::applySettings);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::applySettings() {
+  mSettingsQueued = false;
+
+  const int buttonWidthOld = mButtonWidth;
+  const int buttonHeightOld = mButtonHeight;
+  const bool autoRotateOld = mAutoRotate;
   bool groupingEnabledOld = mGroupingEnabled;
   bool ungroupedNextToExistingOld = mUngroupedNextToExisting;
   bool showOnlyOneDesktopTasksOld = mShowOnlyOneDesktopTasks;
@@ -376,6 +871,9 @@ void OneG4TaskBar::settingsChanged() {
   const bool iconByClassOld = mIconByClass;
   const qreal buttonOpacityOld = mButtonOpacity;
   const qreal groupPopupOpacityOld = mGroupPopupOpacity;
+  const int filterPropertiesOld = filterProperties();
+  const bool paintedTaskListOld = mPaintedTaskList;
+  const QStringList excludedListOld = mExcluded.patterns();
 
   mButtonWidth = mPlugin->settings()->value(QStringLiteral("buttonWidth"), 220).toInt();
   mButtonHeight = mPlugin->settings()->value(QStringLiteral("buttonHeight"), 100).toInt();
@@ -400,6 +898,8 @@ void OneG4TaskBar::settingsChanged() {
   mShowGroupOnHover = mPlugin->settings()->value(QStringLiteral("showGroupOnHover"), true).toBool();
   mUngroupedNextToExisting = mPlugin->settings()->value(QStringLiteral("ungroupedNextToExisting"), false).toBool();
   mIconByClass = mPlugin->settings()->value(QStringLiteral("iconByClass"), false).toBool();
+  mPaintedTaskList = mPlugin->settings()->value(QStringLiteral("paintedTaskList"), false).toBool();
+  mUrgencyBlink = mPlugin->settings()->value(QStringLiteral("urgencyBlink"), false).toBool();
   mWheelEventsAction = mPlugin->settings()->value(QStringLiteral("wheelEventsAction"), 1).toInt();
   mWheelDeltaThreshold = mPlugin->settings()->value(QStringLiteral("wheelDeltaThreshold"), 300).toInt();
   mButtonOpacity =
@@ -407,41 +907,58 @@ void OneG4TaskBar::settingsChanged() {
   mGroupPopupOpacity =
       std::clamp(mPlugin->settings()->value(QStringLiteral("groupPopupOpacity"), 60).toInt(), 0, 100) / 100.0;
 
-  mExcludedList = mPlugin->settings()
-                      ->value(QStringLiteral("excludedList"))
-                      .toString()
-                      .split(QRegularExpression(QStringLiteral("\\s*,\\s*")), Qt::SkipEmptyParts);
-  const auto wins = mBackend->getCurrentWindows();
-  for (WId win : wins) {
-    if (mExcludedList.contains(mBackend->getWindowClass(win), Qt::CaseInsensitive))
-      onWindowRemoved(win);
-    else
-      onWindowAdded(win);
+  const QStringList excludedList =
+      OneG4WindowMatcher::splitPatterns(mPlugin->settings()->value(QStringLiteral("excludedList")).toString());
+  if (excludedList != excludedListOld)
+    mExcluded.setPatterns(excludedList);
+
+  // Start over only when the way windows are grouped changed, ungrouped next to existing
+  // makes no difference while grouping is enabled
+  bool rebuild = false;
+  if (paintedTaskListOld != mPaintedTaskList) {
+    setPaintedTaskList(mPaintedTaskList);
+    rebuild = true;
+  }
+  else if (!mPaintedTaskList &&
+           (groupingEnabledOld != mGroupingEnabled ||
+            (!mGroupingEnabled && ungroupedNextToExistingOld != mUngroupedNextToExisting))) {
+    removeAllGroups();
+    rebuild = true;
   }
 
-  // Delete all groups if grouping or ungrouped next to existing feature toggled and start over
-  if (groupingEnabledOld != mGroupingEnabled || ungroupedNextToExistingOld != mUngroupedNextToExisting) {
-    for (int i = mLayout->count() - 1; 0 <= i; --i) {
-      OneG4TaskGroup* group = qobject_cast<OneG4TaskGroup*>(mLayout->itemAt(i)->widget());
-      if (nullptr != group) {
-        mLayout->takeAt(i);
-        group->deleteLater();
-      }
+  // Both calls are no-ops for the windows whose verdict did not change
+  if (rebuild || excludedListOld != excludedList) {
+    const auto wins = mBackend->getCurrentWindows();
+    for (WId win : wins) {
+      if (isExcluded(win))
+        onWindowRemoved(win);
+      else
+        onWindowAdded(win);
     }
-    mKnownWindows.clear();
   }
 
   if (showOnlyOneDesktopTasksOld != mShowOnlyOneDesktopTasks ||
       (mShowOnlyOneDesktopTasks && showDesktopNumOld != mShowDesktopNum) ||
       showOnlyCurrentScreenTasksOld != mShowOnlyCurrentScreenTasks ||
       showOnlyMinimizedTasksOld != mShowOnlyMinimizedTasks)
-    emit showOnlySettingChanged();
+    refreshWindowFilters(filterProperties() & ~filterPropertiesOld);
   if (iconByClassOld != mIconByClass)
     emit iconByClassChanged();
+  if (mUrgencyBlink)
+    startUrgencyBlink();
+  else if (mUrgencyBlinkTimer->isActive())
+    blinkUrgentButtons();
   if (!qFuzzyCompare(buttonOpacityOld, mButtonOpacity) || !qFuzzyCompare(groupPopupOpacityOld, mGroupPopupOpacity))
     refreshOpacities();
-
-  mBackend->reloadWindows();
+  if (buttonWidthOld != mButtonWidth || buttonHeightOld != mButtonHeight || autoRotateOld != mAutoRotate)
+    realign();
+
+  // The stacking order is read from the window manager once, later changes are followed
+  // through the backend signals
+  if (!mSettingsApplied) {
+    mSettingsApplied = true;
+    mBackend->reloadWindows();
+  }
   refreshPlaceholderVisibility();
 }
 
@@ -486,14 +1003,27 @@ void OneG4TaskBar::realign() {
     }
   }
 
+  if (mListView) {
+    // one cell for the view, it lays the tasks out itself
+    mLayout->setRowCount(1);
+    mLayout->setColumnCount(0);
+    maxSize = QSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+    rotated = false;
+    mListView->realign();
+  }
+
   mLayout->setCellMinimumSize(minSize);
   mLayout->setCellMaximumSize(maxSize);
   mLayout->setDirection(rotated ? OneG4::GridLayout::TopToBottom : OneG4::GridLayout::LeftToRight);
   mLayout->setEnabled(true);
 
   // our placement on screen could have been changed
-  emit showOnlySettingChanged();
-  emit refreshIconGeometry();
+  if (screen() != mFilterScreen) {
+    mFilterScreen = screen();
+    if (mBackend && mShowOnlyCurrentScreenTasks)
+      refreshWindowFilters(windowPropertyMask(OneG4TaskBarWindowProperty::Geometry));
+  }
+  queueIconGeometries();
 }
 
 IOneG4Panel* OneG4TaskBar::panel() const {
@@ -505,7 +1035,7 @@ IOneG4Panel* OneG4TaskBar::panel() const {
  ************************************************/
 void OneG4TaskBar::wheelEvent(QWheelEvent* event) {
   // ignore wheel action unless user preference is "cycle windows"
-  if (mWheelEventsAction != 1)
+  if (mWheelEventsAction != 1 && mWheelEventsAction != 6)
     return QFrame::wheelEvent(event);
 
   static int threshold = 0;
@@ -522,35 +1052,32 @@ void OneG4TaskBar::wheelEvent(QWheelEvent* event) {
 
   int D = delta < 0 ? 1 : -1;
 
-  // create temporary list of visible groups in the same order like on the layout
-  QList<OneG4TaskGroup*> list;
-  OneG4TaskGroup* group = nullptr;
-  for (int i = 0; i < mLayout->count(); i++) {
-    QWidget* o = mLayout->itemAt(i)->widget();
-    OneG4TaskGroup* g = qobject_cast<OneG4TaskGroup*>(o);
-    if (!g)
-      continue;
+  if (mListView) {
+    mListView->cycleTasks(D == 1);
+    return QFrame::wheelEvent(event);
+  }
 
-    if (g->isVisible())
-      list.append(g);
-    if (g->isChecked())
-      group = g;
+  if (mWheelEventsAction == 6) {
+    cycleRecentGroups(D == 1);
+    return QFrame::wheelEvent(event);
   }
 
+  const QVector<OneG4TaskGroup*>& list = visibleGroups();
   if (list.isEmpty())
     return QFrame::wheelEvent(event);
 
-  if (!group)
-    group = list.at(0);
+  // start from the group of the active window, it is the checked one
+  int idx = mVisibleGroupIndex.value(mKnownWindows.value(mActiveWindow, nullptr), 0);
+  OneG4TaskGroup* group = list.at(idx);
 
   OneG4TaskButton* button = nullptr;
 
-  // switching between groups from temporary list in modulo addressing
+  // switching between visible groups in modulo addressing
   while (!button) {
     button = group->getNextPrevChildButton(D == 1, !(list.count() - 1));
     if (button)
       button->raiseApplication();
-    int idx = (list.indexOf(group) + D + list.count()) % list.count();
+    idx = (idx + D + list.count()) % list.count();
     group = list.at(idx);
   }
   QFrame::wheelEvent(event);
@@ -560,7 +1087,7 @@ void OneG4TaskBar::wheelEvent(QWheelEvent* event) {
 
  ************************************************/
 void OneG4TaskBar::resizeEvent(QResizeEvent* event) {
-  emit refreshIconGeometry();
+  queueIconGeometries();
   return QWidget::resizeEvent(event);
 }
 
@@ -572,20 +1099,51 @@ void OneG4TaskBar::changeEvent(QEvent* event) {
   // so we can apply the new style correctly to task buttons.
   if (event->type() == QEvent::StyleChange)
     mStyle->setBaseStyle(nullptr);
+  if (event->type() == QEvent::StyleChange || event->type() == QEvent::PaletteChange)
+    mUrgentPaletteValid = false;
 
   QFrame::changeEvent(event);
 }
 
 void OneG4TaskBar::activateTask(int pos) {
-  for (int i = 1; i < mLayout->count(); ++i) {
-    QWidget* o = mLayout->itemAt(i)->widget();
-    OneG4TaskGroup* g = qobject_cast<OneG4TaskGroup*>(o);
-    if (g && g->isVisible()) {
-      pos--;
-      if (pos == 0) {
-        g->raiseApplication();
-        break;
-      }
+  if (mListView) {
+    mListView->activateTask(pos);
+    return;
+  }
+
+  const QVector<OneG4TaskGroup*>& list = visibleGroups();
+  if (0 < pos && pos <= list.count())
+    list.at(pos - 1)->raiseApplication();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskBar::cycleRecentGroups(bool older) {
+  // raising a group makes it the most recent one, so the order is taken once per wheel gesture
+  if (!mRecentCycleClock.isValid() || mRecentCycleClock.elapsed() > kRecentCycleTimeout) {
+    QVector<OneG4TaskGroup*> groups = visibleGroups();
+    std::stable_sort(groups.begin(), groups.end(), [](const OneG4TaskGroup* a, const OneG4TaskGroup* b) {
+      return a->activationStamp() > b->activationStamp();
+    });
+    mRecentGroups.clear();
+    for (OneG4TaskGroup* group : std::as_const(groups))
+      mRecentGroups.append(group);
+    mRecentGroupPos = 0;
+  }
+  mRecentCycleClock.start();
+
+  // groups removed or hidden since the order was taken are skipped
+  const int count = mRecentGroups.count();
+  for (int step = 1; step <= count; ++step) {
+    const int pos = ((mRecentGroupPos + (older ? step : -step)) % count + count) % count;
+    OneG4TaskGroup* group = mRecentGroups.at(pos);
+    if (!group || !group->isVisibleTo(this))
+      continue;
+    if (OneG4TaskButton* button = group->recentButton()) {
+      mRecentGroupPos = pos;
+      button->raiseApplication();
+      return;
     }
   }
 }
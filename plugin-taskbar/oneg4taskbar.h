@@ -7,16 +7,25 @@
 
 #include <QFrame>
 #include <QBoxLayout>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QMap>
+#include <QPointer>
+#include <QSet>
 
 #include "../panel/ioneg4panel.h"
+#include "oneg4windowmatcher.h"
 
 class IOneG4Panel;
 class IOneG4PanelPlugin;
 
+class QScreen;
 class QSignalMapper;
+class QTimer;
 
+class OneG4TaskButton;
 class OneG4TaskGroup;
+class OneG4TaskListView;
 
 class LeftAlignedTextStyle;
 
@@ -37,6 +46,7 @@ class OneG4TaskBar : public QFrame {
 
   Qt::ToolButtonStyle buttonStyle() const { return mButtonStyle; }
   int buttonWidth() const { return mButtonWidth; }
+  int buttonHeight() const { return mButtonHeight; }
   bool closeOnMiddleClick() const { return mCloseOnMiddleClick; }
   bool raiseOnCurrentDesktop() const { return mRaiseOnCurrentDesktop; }
   bool isShowOnlyOneDesktopTasks() const { return mShowOnlyOneDesktopTasks; }
@@ -55,16 +65,28 @@ class OneG4TaskBar : public QFrame {
   IOneG4Panel* panel() const;
   inline IOneG4PanelPlugin* plugin() const { return mPlugin; }
 
+  // Colours of urgent buttons as the theme styles them, resolved again only when the theme changes
+  const QPalette& urgentPalette();
+  // true during the blink phase in which urgent buttons are painted like the others
+  bool isUrgencyBlinkOff() const { return mUrgencyBlinkOff; }
+  // Called when a button becomes urgent, the blinking stops by itself once none is left
+  void startUrgencyBlink();
+
+  // Popup buttons of closed windows are kept for the next windows instead of being destroyed
+  OneG4TaskButton* takeButton(WId window, QWidget* parent);
+  void recycleButton(OneG4TaskButton* button);
+
   inline IOneG4AbstractWMInterface* getBackend() const { return mBackend; }
 
+  // Cached result of the "show only" filters, unknown windows are visible
+  bool isWindowVisible(WId window) const;
+
  public slots:
   void settingsChanged();
 
  signals:
   void buttonRotationRefreshed(bool autoRotate, IOneG4Panel::Position position);
   void buttonStyleRefreshed(Qt::ToolButtonStyle buttonStyle);
-  void refreshIconGeometry();
-  void showOnlySettingChanged();
   void iconByClassChanged();
   void popupShown(OneG4TaskGroup* sender);
 
@@ -75,24 +97,81 @@ class OneG4TaskBar : public QFrame {
  private slots:
   void refreshButtonRotation();
   void refreshPlaceholderVisibility();
+  void publishIconGeometries();
+  void blinkUrgentButtons();
   void groupBecomeEmptySlot();
 
-  void onWindowChanged(WId window, int prop);
+  void onWindowChanged(WId window, int props);
   void onWindowAdded(WId window);
   void onWindowRemoved(WId window);
+  void onWindowScreenChanged(WId window);
+  void onActiveWindowChanged(WId window);
+  void onDesktopChanged(int desktop);
 
   void activateTask(int pos);
 
  private:
   typedef QMap<WId, OneG4TaskGroup*> windowMap_t;
 
+  // Last known inputs of the "show only" filters for one window
+  struct WindowFilter {
+    int desktop = 0;
+    bool onScreen = true;
+    bool minimized = false;
+    bool visible = true;
+  };
+
  private:
+  bool isExcluded(WId window);
   void addWindow(WId window);
   windowMap_t::iterator removeWindow(windowMap_t::iterator pos);
   void buttonMove(OneG4TaskGroup* dst, OneG4TaskGroup* src, QPoint const& pos);
 
+  // Mask of the window properties the enabled "show only" filters depend on,
+  // Geometry stands for the window's screen which has its own notification
+  int filterProperties() const;
+  bool acceptsWindow(const WindowFilter& filter) const;
+  // Re-reads the inputs selected by props, returns true if the window's visibility flipped
+  bool updateWindowFilter(WId window, int props);
+  // Re-evaluates every known window, re-reading the inputs selected by props first
+  void refreshWindowFilters(int props);
+  void refreshGroupsVisibility(const QSet<OneG4TaskGroup*>& groups);
+  // Icon geometries are published once per event loop turn, whatever asked for them
+  void queueIconGeometries();
+  const QString& windowClass(WId window);
+  // Finds the last group of the class in the layout, walking back from the index (the end if -1)
+  void refreshLastGroupOfClass(const QString& window_class, int from = -1);
+  void removeAllGroups();
+  void setPaintedTaskList(bool painted);
+  // Visible groups in layout order, rebuilt on the first use after a group was added, removed,
+  // moved, shown or hidden
+  const QVector<OneG4TaskGroup*>& visibleGroups();
+  void invalidateVisibleGroups() { mVisibleGroupsValid = false; }
+  // Raises the next group in most recently used order, the order is kept while the wheel turns
+  void cycleRecentGroups(bool older);
+  // Applies what changed in the settings since the previous call
+  void applySettings();
+
  private:
   QMap<WId, OneG4TaskGroup*> mKnownWindows;  //!< Ids of known windows (mapping to buttons/groups)
+  QHash<QString, OneG4TaskGroup*> mGroups;   //!< groups by name
+  QHash<QString, OneG4TaskGroup*> mLastGroupOfClass;  //!< where ungrouped buttons of a class are added
+  QHash<WId, QString> mWindowClasses;        //!< classes of the known windows, dropped when they change
+  WId mActiveWindow;                          //!< the window whose button is checked
+  int mCurrentDesktop;
+  QHash<WId, WindowFilter> mWindowFilters;
+  QScreen* mFilterScreen;      //!< screen the onScreen bits were computed for
+  bool mRefreshingVisibility;  //!< groups are being refreshed in a batch
+  bool mIconGeometriesQueued;
+  QVector<OneG4TaskGroup*> mVisibleGroups;
+  QHash<OneG4TaskGroup*, int> mVisibleGroupIndex;  //!< positions in mVisibleGroups
+  bool mVisibleGroupsValid;
+  QVector<QPointer<OneG4TaskGroup>> mRecentGroups;  //!< most recently used first, while cycling
+  int mRecentGroupPos;
+  QElapsedTimer mRecentCycleClock;  //!< time since the last step through mRecentGroups
+  bool mSettingsQueued;   //!< settings are applied once per event loop turn
+  bool mSettingsApplied;  //!< settings were applied at least once
+  OneG4TaskListView* mListView;  //!< replaces the groups in the painted mode
   OneG4::GridLayout* mLayout;
   QSignalMapper* mSignalMapper;
 
@@ -111,6 +190,7 @@ class OneG4TaskBar : public QFrame {
   bool mShowGroupOnHover;
   bool mUngroupedNextToExisting;
   bool mIconByClass;
+  bool mPaintedTaskList;
   int mWheelEventsAction;
   int mWheelDeltaThreshold;
   qreal mButtonOpacity;
@@ -129,7 +209,15 @@ class OneG4TaskBar : public QFrame {
 
   IOneG4AbstractWMInterface* mBackend;
 
-  QStringList mExcludedList;
+  OneG4WindowMatcher mExcluded;
+  QVector<OneG4TaskButton*> mButtonPool;  //!< hidden buttons waiting for a window
+
+  OneG4TaskButton* mUrgentProbe;  //!< never shown, styled as an urgent button, created on first use
+  QPalette mUrgentPalette;
+  bool mUrgentPaletteValid;
+  bool mUrgencyBlink;
+  bool mUrgencyBlinkOff;
+  QTimer* mUrgencyBlinkTimer;
 };
 
 #endif  // ONEG4TASKBAR_H
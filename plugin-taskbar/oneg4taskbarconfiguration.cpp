@@ -28,6 +28,7 @@ OneG4TaskbarConfiguration::OneG4TaskbarConfiguration(PluginSettings* settings, Q
   ui->wheelEventsActionCB->addItem(tr("Scroll up to minimize, down to raise"), 3);
   ui->wheelEventsActionCB->addItem(tr("Scroll up to move to next desktop, down to previous"), 4);
   ui->wheelEventsActionCB->addItem(tr("Scroll up to move to previous desktop, down to next"), 5);
+  ui->wheelEventsActionCB->addItem(tr("Cycle windows in most recently used order"), 6);
 
   OneG4PanelApplication* a = reinterpret_cast<OneG4PanelApplication*>(qApp);
   auto wmBackend = a->getWMBackend();
@@ -82,6 +83,8 @@ OneG4TaskbarConfiguration::OneG4TaskbarConfiguration(PluginSettings* settings, Q
   connect(ui->showGroupOnHoverCB, &QAbstractButton::clicked, this, &OneG4TaskbarConfiguration::saveSettings);
   connect(ui->ungroupedNextToExistingCB, &QAbstractButton::clicked, this, &OneG4TaskbarConfiguration::saveSettings);
   connect(ui->iconByClassCB, &QAbstractButton::clicked, this, &OneG4TaskbarConfiguration::saveSettings);
+  connect(ui->paintedTaskListCB, &QAbstractButton::clicked, this, &OneG4TaskbarConfiguration::saveSettings);
+  connect(ui->urgencyBlinkCB, &QAbstractButton::clicked, this, &OneG4TaskbarConfiguration::saveSettings);
   connect(ui->wheelEventsActionCB, &QComboBox::activated, this, &OneG4TaskbarConfiguration::saveSettings);
   connect(ui->wheelDeltaThresholdSB,
           static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
@@ -117,6 +120,8 @@ void OneG4TaskbarConfiguration::loadSettings() {
   ui->ungroupedNextToExistingCB->setChecked(
       settings().value(QStringLiteral("ungroupedNextToExisting"), false).toBool());
   ui->iconByClassCB->setChecked(settings().value(QStringLiteral("iconByClass"), false).toBool());
+  ui->paintedTaskListCB->setChecked(settings().value(QStringLiteral("paintedTaskList"), false).toBool());
+  ui->urgencyBlinkCB->setChecked(settings().value(QStringLiteral("urgencyBlink"), false).toBool());
   ui->wheelEventsActionCB->setCurrentIndex(
       ui->wheelEventsActionCB->findData(settings().value(QStringLiteral("wheelEventsAction"), 1).toInt()));
   ui->wheelDeltaThresholdSB->setValue(settings().value(QStringLiteral("wheelDeltaThreshold"), 300).toInt());
@@ -141,6 +146,8 @@ void OneG4TaskbarConfiguration::saveSettings() {
   settings().setValue(QStringLiteral("showGroupOnHover"), ui->showGroupOnHoverCB->isChecked());
   settings().setValue(QStringLiteral("ungroupedNextToExisting"), ui->ungroupedNextToExistingCB->isChecked());
   settings().setValue(QStringLiteral("iconByClass"), ui->iconByClassCB->isChecked());
+  settings().setValue(QStringLiteral("paintedTaskList"), ui->paintedTaskListCB->isChecked());
+  settings().setValue(QStringLiteral("urgencyBlink"), ui->urgencyBlinkCB->isChecked());
   settings().setValue(QStringLiteral("wheelEventsAction"),
                       ui->wheelEventsActionCB->itemData(ui->wheelEventsActionCB->currentIndex()));
   settings().setValue(QStringLiteral("wheelDeltaThreshold"), ui->wheelDeltaThresholdSB->value());
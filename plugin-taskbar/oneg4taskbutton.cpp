@@ -4,6 +4,7 @@
 
 #include "oneg4taskbutton.h"
 #include "oneg4taskbar.h"
+#include "oneg4taskiconcache.h"
 
 #include "../panel/ioneg4panelplugin.h"
 
@@ -28,12 +29,17 @@
 #include <QPointer>
 #include <QCursor>
 #include <QEasingCurve>
-#include <QVariantAnimation>
 #include <algorithm>
 
 #include "../panel/backends/ioneg4abstractwmiface.h"
+#include "../panel/oneg4animationdriver.h"
+
+namespace {
+constexpr int kHoverAnimation = 0;
+}  // namespace
 
 bool OneG4TaskButton::sDraggging = false;
+const OneG4TaskButton* OneG4TaskButton::sPaintingButton = nullptr;
 
 /************************************************
 
@@ -45,11 +51,17 @@ void LeftAlignedTextStyle::drawItemText(QPainter* painter,
                                         bool enabled,
                                         const QString& text,
                                         QPalette::ColorRole textRole) const {
-  QString txt = text;
-  // get the button text because the text that's given to this function may be middle-elided
-  if (const QToolButton* tb = dynamic_cast<const QToolButton*>(painter->device()))
-    txt = tb->text();
-  txt = QFontMetrics(painter->font()).elidedText(txt, Qt::ElideRight, rect.width());
+  // use the button text because the text that's given to this function may be middle-elided
+  QString txt;
+  if (const OneG4TaskButton* button = OneG4TaskButton::paintingButton()) {
+    txt = button->elidedText(painter->font(), rect.width());
+  }
+  else {
+    txt = text;
+    if (const QToolButton* tb = dynamic_cast<const QToolButton*>(painter->device()))
+      txt = tb->text();
+    txt = QFontMetrics(painter->font()).elidedText(txt, Qt::ElideRight, rect.width());
+  }
   QProxyStyle::drawItemText(painter, rect, (flags & ~Qt::AlignHCenter) | Qt::AlignLeft, pal, enabled, txt, textRole);
 }
 
@@ -65,11 +77,7 @@ OneG4TaskButton::OneG4TaskButton(const WId window, OneG4TaskBar* taskbar, QWidge
       mParentTaskBar(taskbar),
       mPlugin(mParentTaskBar->plugin()),
       mIconSize(mPlugin->panel()->iconSize()),
-      mWheelDelta(0),
-      mDNDTimer(new QTimer(this)),
-      mWheelTimer(new QTimer(this)),
-      mHoverAnimation(new QVariantAnimation(this)),
-      mBasePalette(palette()) {
+      mWheelDelta(0) {
   Q_ASSERT(taskbar);
 
   setCheckable(true);
@@ -82,39 +90,87 @@ OneG4TaskButton::OneG4TaskButton(const WId window, OneG4TaskBar* taskbar, QWidge
   setMouseTracking(true);
   setAttribute(Qt::WA_Hover, true);
 
-  updateText();
-  updateIcon();
-
-  mDNDTimer->setSingleShot(true);
-  mDNDTimer->setInterval(700);
-  connect(mDNDTimer, &QTimer::timeout, this, &OneG4TaskButton::raiseApplication);
+  // the taskbar's urgency probe has no window to read
+  if (mWindow != 0) {
+    updateText();
+    updateIcon();
+    setUrgencyHint(mBackend->applicationDemandsAttention(mWindow));
+  }
 
-  mWheelTimer->setSingleShot(true);
-  mWheelTimer->setInterval(250);
-  connect(mWheelTimer, &QTimer::timeout, this, [this] {
-    mWheelDelta = 0;  // forget previous wheel deltas
+  connect(OneG4TaskIconCache::instance(), &OneG4TaskIconCache::iconsInvalidated, this, &OneG4TaskButton::updateIcon);
+  connect(OneG4TaskIconCache::instance(), &OneG4TaskIconCache::iconReady, this, [this](const QString& key) {
+    if (key == mIconKey)
+      updateIcon();
   });
+  connect(mParentTaskBar, &OneG4TaskBar::iconByClassChanged, this, &OneG4TaskButton::updateIcon);
+}
 
-  mHoverAnimation->setDuration(120);
-  mHoverAnimation->setEasingCurve(QEasingCurve::OutCubic);
-  mHoverAnimation->setStartValue(0.0);
-  mHoverAnimation->setEndValue(0.0);
-  connect(mHoverAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant& value) {
-    mHoverProgress = value.toReal();
-    update();
-  });
+/************************************************
 
+ ************************************************/
+OneG4TaskButton::~OneG4TaskButton() = default;
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskButton::resetWindow(WId window) {
+  mWindow = window;
+  mWheelDelta = 0;
+  if (mDNDTimer)
+    mDNDTimer->stop();
+  if (mWheelTimer)
+    mWheelTimer->stop();
+  OneG4AnimationDriver::instance()->stop(this, kHoverAnimation);
+  mHoverProgress = 0.0;
+  mHoverTarget = false;
+  setAttribute(Qt::WA_UnderMouse, false);
+  setChecked(false);
+  setOrigin(Qt::TopLeftCorner);
+
+  updateText();
+  updateIcon();
   setUrgencyHint(mBackend->applicationDemandsAttention(mWindow));
+}
 
-  connect(OneG4::Settings::globalSettings(), &OneG4::GlobalSettings::iconThemeChanged, this,
-          &OneG4TaskButton::updateIcon);
-  connect(mParentTaskBar, &OneG4TaskBar::iconByClassChanged, this, &OneG4TaskButton::updateIcon);
+/************************************************
+
+ ************************************************/
+void OneG4TaskButton::releaseWindow() {
+  // a pooled button still receives the icon cache signals, it must not read a closed window
+  mWindow = 0;
+  mIconKey.clear();
+  if (mDNDTimer)
+    mDNDTimer->stop();
+  if (mWheelTimer)
+    mWheelTimer->stop();
+  setIcon(QIcon());
+  setUrgencyHint(false);
 }
 
 /************************************************
 
  ************************************************/
-OneG4TaskButton::~OneG4TaskButton() = default;
+QTimer* OneG4TaskButton::dndTimer() {
+  if (!mDNDTimer) {
+    mDNDTimer = new QTimer(this);
+    mDNDTimer->setSingleShot(true);
+    mDNDTimer->setInterval(700);
+    connect(mDNDTimer, &QTimer::timeout, this, &OneG4TaskButton::raiseApplication);
+  }
+  return mDNDTimer;
+}
+
+QTimer* OneG4TaskButton::wheelTimer() {
+  if (!mWheelTimer) {
+    mWheelTimer = new QTimer(this);
+    mWheelTimer->setSingleShot(true);
+    mWheelTimer->setInterval(250);
+    connect(mWheelTimer, &QTimer::timeout, this, [this] {
+      mWheelDelta = 0;  // forget previous wheel deltas
+    });
+  }
+  return mWheelTimer;
+}
 
 /************************************************
  *
@@ -137,16 +193,37 @@ void OneG4TaskButton::updateText() {
 /************************************************
 
  ************************************************/
-void OneG4TaskButton::updateIcon() {
-  QIcon ico;
-  if (mParentTaskBar->isIconByClass()) {
-    ico = XdgIcon::fromTheme(mBackend->getWindowClass(mWindow).toLower());
+const QString& OneG4TaskButton::elidedText(const QFont& font, int width) const {
+  const QString source = text();
+  if (width != mElidedWidth || source != mElidedSource || font != mElidedFont) {
+    mElidedSource = source;
+    mElidedFont = font;
+    mElidedWidth = width;
+    mElidedText = QFontMetrics(font).elidedText(source, Qt::ElideRight, width);
   }
-  if (ico.isNull()) {
-    int devicePixels = mIconSize * devicePixelRatioF();
-    ico = mBackend->getApplicationIcon(mWindow, devicePixels);
+  return mElidedText;
+}
+
+/************************************************
+
+ ************************************************/
+int OneG4TaskButton::textWidth(const QFont& font) const {
+  if (mTextWidth < 0 || font != mTextWidthFont) {
+    mTextWidthFont = font;
+    mTextWidth = QFontMetrics(font).horizontalAdvance(text());
   }
-  setIcon(ico.isNull() ? XdgIcon::defaultApplicationIcon() : ico);
+  return mTextWidth;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskButton::updateIcon() {
+  if (mWindow == 0)
+    return;
+
+  setIcon(OneG4TaskIconCache::instance()->icon(mBackend, mWindow, mIconSize, devicePixelRatioF(),
+                                               mParentTaskBar->isIconByClass(), &mIconKey));
 }
 
 /************************************************
@@ -163,9 +240,6 @@ void OneG4TaskButton::changeEvent(QEvent* event) {
     }
   }
 
-  if (event->type() == QEvent::PaletteChange || event->type() == QEvent::StyleChange)
-    mBasePalette = palette();
-
   QToolButton::changeEvent(event);
 }
 
@@ -182,7 +256,7 @@ void OneG4TaskButton::dragEnterEvent(QDragEnterEvent* event) {
     updateHoverAnimation(false);
   }
   else {
-    mDNDTimer->start();
+    dndTimer()->start();
   }
 
   QToolButton::dragEnterEvent(event);
@@ -197,13 +271,15 @@ void OneG4TaskButton::dragMoveEvent(QDragMoveEvent* event) {
 }
 
 void OneG4TaskButton::dragLeaveEvent(QDragLeaveEvent* event) {
-  mDNDTimer->stop();
+  if (mDNDTimer)
+    mDNDTimer->stop();
   updateHoverAnimation(false);
   QToolButton::dragLeaveEvent(event);
 }
 
 void OneG4TaskButton::dropEvent(QDropEvent* event) {
-  mDNDTimer->stop();
+  if (mDNDTimer)
+    mDNDTimer->stop();
   if (event->mimeData()->hasFormat(mimeDataFormat())) {
     emit dropped(event->source(), event->position().toPoint());
     setAttribute(Qt::WA_UnderMouse, false);
@@ -250,17 +326,14 @@ void OneG4TaskButton::leaveEvent(QEvent* event) {
 
  ************************************************/
 void OneG4TaskButton::updateHoverAnimation(bool hovered) {
-  if (!mHoverAnimation)
-    return;
-
   const qreal endValue = hovered ? 1.0 : 0.0;
 
   if (hovered == mHoverTarget) {
     if ((hovered && mHoverProgress >= 1.0) || (!hovered && mHoverProgress <= 0.0))
       return;
 
-    if (mHoverAnimation->state() == QAbstractAnimation::Running &&
-        qFuzzyCompare(mHoverAnimation->endValue().toReal(), endValue))
+    // already heading there
+    if (OneG4AnimationDriver::instance()->isRunning(this, kHoverAnimation))
       return;
   }
 
@@ -272,10 +345,12 @@ void OneG4TaskButton::updateHoverAnimation(bool hovered) {
     return;
   }
 
-  mHoverAnimation->stop();
-  mHoverAnimation->setStartValue(mHoverProgress);
-  mHoverAnimation->setEndValue(endValue);
-  mHoverAnimation->start();
+  const qreal startValue = mHoverProgress;
+  OneG4AnimationDriver::instance()->start(this, kHoverAnimation, 120, QEasingCurve::OutCubic,
+                                          [this, startValue, endValue](qreal progress) {
+                                            mHoverProgress = startValue + (endValue - startValue) * progress;
+                                            OneG4AnimationDriver::instance()->scheduleRepaint(this);
+                                          });
 }
 
 /************************************************
@@ -317,21 +392,22 @@ void OneG4TaskButton::wheelEvent(QWheelEvent* event) {
   Qt::Orientation orient = (qAbs(angleDelta.x()) > qAbs(angleDelta.y()) ? Qt::Horizontal : Qt::Vertical);
   int delta = (orient == Qt::Horizontal ? angleDelta.x() : angleDelta.y());
 
-  if (!mWheelTimer->isActive())
+  QTimer* timer = wheelTimer();
+  if (!timer->isActive())
     mWheelDelta += qAbs(delta);
   else {
     // NOTE: We should consider a short delay after the last wheel event
     // in order to distinguish between separate wheel rotations; otherwise,
     // a wheel delta threshold will not make much sense because the delta
     // might have been increased due to a previous and separate wheel rotation.
-    mWheelTimer->start();
+    timer->start();
   }
 
   if (mWheelDelta < mParentTaskBar->wheelDeltaThreshold())
     return QToolButton::wheelEvent(event);
   else {
     mWheelDelta = 0;
-    mWheelTimer->start();  // start to distinguish between separate wheel rotations
+    timer->start();  // start to distinguish between separate wheel rotations
   }
 
   int D = delta < 0 ? 1 : -1;
@@ -385,6 +461,7 @@ void OneG4TaskButton::setTextExplicitly(const QString& str) {
   }
 
   mExplicitlySetText = str;
+  mTextWidth = -1;
   setText(mExplicitlySetText);
 }
 
@@ -745,10 +822,10 @@ void OneG4TaskButton::setUrgencyHint(bool set) {
   if (mUrgencyHint == set)
     return;
 
+  // painted from the taskbar's pre-resolved colours, re-polishing would re-run the stylesheet
   mUrgencyHint = set;
-  setProperty("urgent", set);
-  style()->unpolish(this);
-  style()->polish(this);
+  if (set)
+    mParentTaskBar->startUrgencyBlink();
   update();
 }
 
@@ -760,15 +837,6 @@ bool OneG4TaskButton::isOnDesktop(int desktop) const {
   return d == desktop || d == mBackend->onAllWorkspacesEnum();
 }
 
-bool OneG4TaskButton::isOnCurrentScreen() const {
-  QScreen* screen = parentTaskBar()->screen();
-  return mBackend->isWindowOnScreen(screen, mWindow);
-}
-
-bool OneG4TaskButton::isMinimized() const {
-  return mBackend->getWindowState(mWindow) == OneG4TaskBarWindowState::Minimized;
-}
-
 Qt::Corner OneG4TaskButton::origin() const {
   return mOrigin;
 }
@@ -804,8 +872,10 @@ void OneG4TaskButton::setAutoRotation(bool value, IOneG4Panel::Position position
 void OneG4TaskButton::paintEvent(QPaintEvent* event) {
   Q_UNUSED(event);
   QStyleOptionToolButton opt;
+  // initStyleOption() takes the palette of the moment, urgency is no longer styled into it
   initStyleOption(&opt);
-  opt.palette = mBasePalette;
+  if (mUrgencyHint && !mParentTaskBar->isUrgencyBlinkOff())
+    opt.palette = mParentTaskBar->urgentPalette();
 
   QSize sz = size();
   bool transpose = false;
@@ -894,9 +964,11 @@ void OneG4TaskButton::paintEvent(QPaintEvent* event) {
 
   // Draw label/icon with the original palette (no opacity on text/icon)
   opt.rect = opt.rect.adjusted(2, 2, -2, -2);
+  sPaintingButton = this;
   style()->drawControl(QStyle::CE_ToolButtonLabel, &opt, &painter, this);
+  sPaintingButton = nullptr;
 }
 
 bool OneG4TaskButton::hasDragAndDropHover() const {
-  return mDNDTimer->isActive();
+  return mDNDTimer && mDNDTimer->isActive();
 }
@@ -9,8 +9,6 @@
 #include <QProxyStyle>
 #include <QToolButton>
 
-class QVariantAnimation;
-
 #include "../panel/ioneg4panel.h"
 
 class QPainter;
@@ -45,13 +43,15 @@ class OneG4TaskButton : public QToolButton {
   bool isApplicationHidden() const;
   bool isApplicationActive() const;
   WId windowId() const { return mWindow; }
+  // Binds a pooled button to another window, as if it was newly created for it
+  void resetWindow(WId window);
+  // Unbinds the button from its closed window before it is pooled
+  void releaseWindow();
 
   bool hasUrgencyHint() const { return mUrgencyHint; }
   void setUrgencyHint(bool set);
 
   bool isOnDesktop(int desktop) const;
-  bool isOnCurrentScreen() const;
-  bool isMinimized() const;
   void updateText();
 
   Qt::Corner origin() const;
@@ -59,6 +59,13 @@ class OneG4TaskButton : public QToolButton {
 
   OneG4TaskBar* parentTaskBar() const { return mParentTaskBar; }
 
+  // The button whose label is being painted, LeftAlignedTextStyle elides its text
+  static const OneG4TaskButton* paintingButton() { return sPaintingButton; }
+  // text() elided to width, kept until the text, the font or the width changes
+  const QString& elidedText(const QFont& font, int width) const;
+  // Width of text() in font, kept until the text or the font changes
+  int textWidth(const QFont& font) const;
+
   static QString mimeDataFormat() { return QLatin1String("oneg4/oneg4taskbutton"); }
   /*! \return true if this button received DragEnter event (and no DragLeave event yet)
    * */
@@ -114,6 +121,10 @@ class OneG4TaskButton : public QToolButton {
  private:
   void moveApplicationToPrevNextDesktop(bool next);
   void moveApplicationToPrevNextMonitor(bool next);
+  // Created on first use, most buttons never see a drag or a wheel rotation
+  QTimer* dndTimer();
+  QTimer* wheelTimer();
+
   WId mWindow;
   bool mUrgencyHint;
   QPoint mDragStartPosition;
@@ -125,17 +136,25 @@ class OneG4TaskButton : public QToolButton {
 
   QString mExplicitlySetText;
 
+  // hover animations repaint many times with the same title
+  mutable QString mElidedSource;
+  mutable QFont mElidedFont;
+  mutable int mElidedWidth = -1;
+  mutable QString mElidedText;
+  mutable QFont mTextWidthFont;
+  mutable int mTextWidth = -1;
+  static const OneG4TaskButton* sPaintingButton;
+  QString mIconKey;  // OneG4TaskIconCache key of the shown icon
+
   // Timer for when draggind something into a button (the button's window
   // must be activated so that the use can continue dragging to the window
-  QTimer* mDNDTimer;
+  QTimer* mDNDTimer = nullptr;
 
   // Timer for distinguishing between separate mouse wheel rotations
-  QTimer* mWheelTimer;
+  QTimer* mWheelTimer = nullptr;
   qreal mOpacity = 1.0;
   qreal mHoverProgress = 0.0;
   bool mHoverTarget = false;
-  QVariantAnimation* mHoverAnimation = nullptr;
-  QPalette mBasePalette;
 
  signals:
   void dropped(QObject* dragSource, QPoint const& pos);
@@ -20,6 +20,8 @@
 
 #include "../panel/backends/ioneg4abstractwmiface.h"
 
+quint64 OneG4TaskGroup::sActivationClock = 0;
+
 /************************************************
 
  ************************************************/
@@ -38,12 +40,8 @@ OneG4TaskGroup::OneG4TaskGroup(const QString& groupName, WId window, OneG4TaskBa
 
   connect(this, &OneG4TaskGroup::clicked, this, &OneG4TaskGroup::onClicked);
   connect(parent, &OneG4TaskBar::buttonRotationRefreshed, this, &OneG4TaskGroup::setAutoRotation);
-  connect(parent, &OneG4TaskBar::refreshIconGeometry, this, &OneG4TaskGroup::refreshIconsGeometry);
   connect(parent, &OneG4TaskBar::buttonStyleRefreshed, this, &OneG4TaskGroup::setToolButtonsStyle);
-  connect(parent, &OneG4TaskBar::showOnlySettingChanged, this, &OneG4TaskGroup::refreshVisibility);
   connect(parent, &OneG4TaskBar::popupShown, this, &OneG4TaskGroup::groupPopupShown);
-  connect(mBackend, &IOneG4AbstractWMInterface::currentWorkspaceChanged, this, &OneG4TaskGroup::onDesktopChanged);
-  connect(mBackend, &IOneG4AbstractWMInterface::activeWindowChanged, this, &OneG4TaskGroup::onActiveWindowChanged);
 }
 
 /************************************************
@@ -83,7 +81,7 @@ OneG4TaskButton* OneG4TaskGroup::addWindow(WId id) {
   if (mButtonHash.contains(id))
     return mButtonHash.value(id);
 
-  OneG4TaskButton* btn = new OneG4TaskButton(id, parentTaskBar(), mPopup);
+  OneG4TaskButton* btn = parentTaskBar()->takeButton(id, mPopup);
   btn->setToolButtonStyle(popupButtonStyle());
   btn->setOpacity(mButtonOpacity);
 
@@ -94,6 +92,7 @@ OneG4TaskButton* OneG4TaskGroup::addWindow(WId id) {
 
   mButtonHash.insert(id, btn);
   mPopup->addButton(btn);
+  addTextWidth(btn->textWidth(font()));
 
   connect(btn, &OneG4TaskButton::clicked, this, &OneG4TaskGroup::onChildButtonClicked);
   refreshVisibility();
@@ -159,15 +158,18 @@ OneG4TaskButton* OneG4TaskGroup::getNextPrevChildButton(bool next, bool circular
 /************************************************
 
  ************************************************/
-void OneG4TaskGroup::onActiveWindowChanged(WId window) {
+void OneG4TaskGroup::onActiveWindowChanged(WId window, WId previousWindow) {
+  if (OneG4TaskButton* previous = mButtonHash.value(previousWindow, nullptr))
+    previous->setChecked(false);
+
   OneG4TaskButton* button = mButtonHash.value(window, nullptr);
-  for (OneG4TaskButton* btn : std::as_const(mButtonHash))
-    btn->setChecked(false);
 
   if (button) {
     button->setChecked(true);
     if (button->hasUrgencyHint())
       button->setUrgencyHint(false);
+    mRecentWindow = window;
+    mActivationStamp = ++sActivationClock;
   }
   setChecked(button != nullptr && button->isVisibleTo(mPopup));
 }
@@ -175,8 +177,16 @@ void OneG4TaskGroup::onActiveWindowChanged(WId window) {
 /************************************************
 
  ************************************************/
-void OneG4TaskGroup::onDesktopChanged(int /*number*/) {
-  refreshVisibility();
+OneG4TaskButton* OneG4TaskGroup::recentButton() const {
+  OneG4TaskButton* button = mButtonHash.value(mRecentWindow, nullptr);
+  if (button && button->isVisibleTo(mPopup))
+    return button;
+
+  for (OneG4TaskButton* btn : std::as_const(mButtonHash)) {
+    if (btn->isVisibleTo(mPopup))
+      return btn;
+  }
+  return nullptr;
 }
 
 /************************************************
@@ -186,8 +196,12 @@ void OneG4TaskGroup::onWindowRemoved(WId window) {
   if (mButtonHash.contains(window)) {
     OneG4TaskButton* button = mButtonHash.value(window);
     mButtonHash.remove(window);
+    if (button->isVisibleTo(mPopup))
+      --mVisibleButtons;
+    removeTextWidth(button->textWidth(font()));
     mPopup->removeWidget(button);
-    button->deleteLater();
+    disconnect(button, nullptr, this, nullptr);
+    parentTaskBar()->recycleButton(button);
 
     if (mButtonHash.count())
       regroup();
@@ -258,12 +272,23 @@ int OneG4TaskGroup::buttonsCount() const {
 
  ************************************************/
 int OneG4TaskGroup::visibleButtonsCount() const {
-  int i = 0;
-  for (OneG4TaskButton* btn : std::as_const(mButtonHash)) {
-    if (btn->isVisibleTo(mPopup))
-      ++i;
-  }
-  return i;
+  return mVisibleButtons;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskGroup::addTextWidth(int width) {
+  ++mTextWidths[width];
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskGroup::removeTextWidth(int width) {
+  auto i = mTextWidths.find(width);
+  if (mTextWidths.end() != i && --(*i) == 0)
+    mTextWidths.erase(i);
 }
 
 /************************************************
@@ -344,22 +369,20 @@ void OneG4TaskGroup::setAutoRotation(bool value, IOneG4Panel::Position position)
 
  ************************************************/
 void OneG4TaskGroup::refreshVisibility() {
-  bool will = false;
   const OneG4TaskBar* taskbar = parentTaskBar();
-  const int showDesktop = taskbar->showDesktopNum();
+  mVisibleButtons = 0;
   for (OneG4TaskButton* btn : std::as_const(mButtonHash)) {
-    bool visible = taskbar->isShowOnlyOneDesktopTasks()
-                       ? btn->isOnDesktop(showDesktop == 0 ? mBackend->getCurrentWorkspace() : showDesktop)
-                       : true;
-    visible &= taskbar->isShowOnlyCurrentScreenTasks() ? btn->isOnCurrentScreen() : true;
-    visible &= taskbar->isShowOnlyMinimizedTasks() ? btn->isMinimized() : true;
+    // the taskbar keeps the filter result up to date
+    const bool visible = taskbar->isWindowVisible(btn->windowId());
     btn->setVisible(visible);
-    will |= visible;
+    if (visible)
+      ++mVisibleButtons;
     // correct the checked state if this button is checked
     if (btn->isChecked())
       setChecked(visible);
   }
 
+  const bool will = mVisibleButtons > 0;
   const bool is = isVisible();
   setVisible(will);
   regroup();
@@ -403,21 +426,39 @@ void OneG4TaskGroup::setPopupVisible(bool visible, bool fast) {
 /************************************************
 
  ************************************************/
-void OneG4TaskGroup::refreshIconsGeometry() {
+void OneG4TaskGroup::refreshIconsGeometry(QHash<WId, QRect>& geometries) {
   QRect rect = geometry();
   rect.moveTo(mapToGlobal(QPoint(0, 0)));
 
   if (mSingleButton) {
-    mBackend->refreshIconGeometry(windowId(), rect);
+    geometries.insert(windowId(), rect);
     return;
   }
 
   for (OneG4TaskButton* but : std::as_const(mButtonHash)) {
-    mBackend->refreshIconGeometry(but->windowId(), rect);
+    geometries.insert(but->windowId(), rect);
     but->setIconSize(QSize(plugin()->panel()->iconSize(), plugin()->panel()->iconSize()));
   }
 }
 
+/************************************************
+
+ ************************************************/
+bool OneG4TaskGroup::repaintUrgentButtons() {
+  bool urgent = false;
+  if (hasUrgencyHint()) {
+    update();
+    urgent = true;
+  }
+  for (OneG4TaskButton* button : std::as_const(mButtonHash)) {
+    if (button->hasUrgencyHint()) {
+      button->update();
+      urgent = true;
+    }
+  }
+  return urgent;
+}
+
 /************************************************
 
  ************************************************/
@@ -449,11 +490,8 @@ int OneG4TaskGroup::recalculateFrameHeight() const {
 
  ************************************************/
 int OneG4TaskGroup::recalculateFrameWidth() const {
-  const QFontMetrics fm = fontMetrics();
-  const int max = 100 * fm.horizontalAdvance(QLatin1Char(' '));  // elide after the max width
-  int txtWidth = 0;
-  for (OneG4TaskButton* btn : std::as_const(mButtonHash))
-    txtWidth = std::max(fm.horizontalAdvance(btn->text()), txtWidth);
+  const int max = 100 * fontMetrics().horizontalAdvance(QLatin1Char(' '));  // elide after the max width
+  const int txtWidth = mTextWidths.isEmpty() ? 0 : mTextWidths.lastKey();
   return iconSize().width() + std::min(txtWidth, max) + 30;  // give enough room to margins and borders
 }
 
@@ -546,6 +584,20 @@ void OneG4TaskGroup::mouseReleaseEvent(QMouseEvent* event) {
     QToolButton::mouseReleaseEvent(event);
 }
 
+/************************************************
+
+ ************************************************/
+void OneG4TaskGroup::changeEvent(QEvent* event) {
+  if (event->type() == QEvent::FontChange) {
+    // the widths are measured in our font
+    mTextWidths.clear();
+    for (OneG4TaskButton* button : std::as_const(mButtonHash))
+      addTextWidth(button->textWidth(font()));
+  }
+
+  OneG4TaskButton::changeEvent(event);
+}
+
 /************************************************
 
  ************************************************/
@@ -562,10 +614,11 @@ void OneG4TaskGroup::wheelEvent(QWheelEvent* event) {
 /************************************************
 
  ************************************************/
-bool OneG4TaskGroup::onWindowChanged(WId window, OneG4TaskBarWindowProperty prop) {
+bool OneG4TaskGroup::onWindowChanged(WId window, int props) {
   // Returns true if the class is preserved
 
-  bool needsRefreshVisibility{false};
+  auto changed = [props](OneG4TaskBarWindowProperty prop) { return props & windowPropertyMask(prop); };
+
   QList<OneG4TaskButton*> buttons;
   if (mButtonHash.contains(window))
     buttons.append(mButtonHash.value(window));
@@ -576,59 +629,40 @@ bool OneG4TaskGroup::onWindowChanged(WId window, OneG4TaskBarWindowProperty prop
 
   if (!buttons.isEmpty()) {
     // if class is changed the window won't belong to our group any more
-    if (parentTaskBar()->isGroupingEnabled() && prop == OneG4TaskBarWindowProperty::WindowClass) {
+    if (parentTaskBar()->isGroupingEnabled() && changed(OneG4TaskBarWindowProperty::WindowClass)) {
       if (mBackend->getWindowClass(windowId()) != mGroupName) {
         onWindowRemoved(window);
         return false;
       }
     }
-    // window changed virtual desktop or may change screen
-    if ((prop == OneG4TaskBarWindowProperty::Workspace && parentTaskBar()->isShowOnlyOneDesktopTasks()) ||
-        (prop == OneG4TaskBarWindowProperty::Geometry && parentTaskBar()->isShowOnlyCurrentScreenTasks())) {
-      needsRefreshVisibility = true;
-    }
-
-    if (prop == OneG4TaskBarWindowProperty::Title) {
-      for (auto* b : buttons)
+    if (changed(OneG4TaskBarWindowProperty::Title)) {
+      for (auto* b : buttons) {
+        if (b == this) {
+          b->updateText();
+          continue;
+        }
+        removeTextWidth(b->textWidth(font()));
         b->updateText();
+        addTextWidth(b->textWidth(font()));
+      }
     }
 
     // XXX: we are setting window icon geometry -> don't need to handle NET::WMIconGeometry
     // Icon of the button can be based on windowClass
-    if (prop == OneG4TaskBarWindowProperty::Icon) {
+    if (changed(OneG4TaskBarWindowProperty::Icon)) {
       for (auto* b : buttons)
         b->updateIcon();
     }
 
-    bool set_urgency = false;
-    bool urgency = false;
-
-    if (prop == OneG4TaskBarWindowProperty::Urgency) {
-      set_urgency = true;
-      // FIXME: original code here did not consider "demand attention", was it intentional?
-      urgency = mBackend->applicationDemandsAttention(window);
-    }
-    if (prop == OneG4TaskBarWindowProperty::State) {
-      if (!set_urgency)
-        urgency = mBackend->applicationDemandsAttention(window);
-
-      for (auto* b : buttons)
-        b->setUrgencyHint(urgency);
-
-      set_urgency = false;
-
-      if (parentTaskBar()->isShowOnlyMinimizedTasks())
-        needsRefreshVisibility = true;
-    }
-    if (set_urgency) {
+    // FIXME: original code here did not consider "demand attention", was it intentional?
+    if (changed(OneG4TaskBarWindowProperty::Urgency) || changed(OneG4TaskBarWindowProperty::State)) {
+      const bool urgency = mBackend->applicationDemandsAttention(window);
       for (auto* b : buttons)
         b->setUrgencyHint(urgency);
     }
   }
 
-  if (needsRefreshVisibility)
-    refreshVisibility();
-
+  // visibility changes are dispatched by the taskbar, see OneG4TaskBar::onWindowChanged()
   return true;
 }
 
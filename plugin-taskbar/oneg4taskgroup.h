@@ -5,6 +5,8 @@
 #ifndef ONEG4TASKGROUP_H
 #define ONEG4TASKGROUP_H
 
+#include <QMap>
+
 #include "oneg4taskbutton.h"
 
 #include "../panel/backends/oneg4taskbartypes.h"
@@ -33,7 +35,15 @@ class OneG4TaskGroup : public OneG4TaskButton {
   // if circular is true, then it will go around the list of buttons
   OneG4TaskButton* getNextPrevChildButton(bool next, bool circular);
 
-  bool onWindowChanged(WId window, OneG4TaskBarWindowProperty prop);
+  // props is a mask of windowPropertyMask() bits
+  bool onWindowChanged(WId window, int props);
+  // Called by the taskbar only for the groups of the previously and the newly active window,
+  // only the buttons of these two windows change
+  void onActiveWindowChanged(WId window, WId previousWindow);
+  // When one of our windows was last activated, larger is more recent
+  quint64 activationStamp() const { return mActivationStamp; }
+  // The visible button of the most recently active of our windows
+  OneG4TaskButton* recentButton() const;
 
   void setAutoRotation(bool value, IOneG4Panel::Position position);
   Qt::ToolButtonStyle popupButtonStyle() const;
@@ -43,8 +53,14 @@ class OneG4TaskGroup : public OneG4TaskButton {
 
   void setPopupVisible(bool visible = true, bool fast = false);
 
+  // Adds where the icons of our windows are, the taskbar publishes them in one batch
+  void refreshIconsGeometry(QHash<WId, QRect>& geometries);
+  // Repaints the urgent buttons for the blink, returns false if there is none
+  bool repaintUrgentButtons();
+
  public slots:
   void onWindowRemoved(WId window);
+  void refreshVisibility();
 
  protected:
   QMimeData* mimeData();
@@ -57,6 +73,7 @@ class OneG4TaskGroup : public OneG4TaskButton {
   void mouseMoveEvent(QMouseEvent* event);
   void mouseReleaseEvent(QMouseEvent* event);
   void wheelEvent(QWheelEvent* event);
+  void changeEvent(QEvent* event);
   int recalculateFrameHeight() const;
   int recalculateFrameWidth() const;
 
@@ -65,12 +82,8 @@ class OneG4TaskGroup : public OneG4TaskButton {
  private slots:
   void onClicked(bool checked);
   void onChildButtonClicked();
-  void onActiveWindowChanged(WId window);
-  void onDesktopChanged(int number);
 
   void closeGroup();
-  void refreshIconsGeometry();
-  void refreshVisibility();
   void groupPopupShown(OneG4TaskGroup* sender);
 
  signals:
@@ -87,10 +100,17 @@ class OneG4TaskGroup : public OneG4TaskButton {
                        //!< in group)
   qreal mButtonOpacity = 1.0;
   qreal mPopupOpacity = 1.0;
+  int mVisibleButtons = 0;     //!< buttons shown in the popup, counted by refreshVisibility()
+  QMap<int, int> mTextWidths;  //!< text width of the buttons -> number of buttons, the widest is last
+  quint64 mActivationStamp = 0;
+  WId mRecentWindow = 0;
+  static quint64 sActivationClock;
 
   QSize recalculateFrameSize();
   QPoint recalculateFramePosition();
   void recalculateFrameIfVisible();
+  void addTextWidth(int width);
+  void removeTextWidth(int width);
   void regroup();
 };
 
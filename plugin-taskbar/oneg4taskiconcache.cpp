@@ -0,0 +1,170 @@
+/* plugin-taskbar/oneg4taskiconcache.cpp
+ * Taskbar plugin implementation
+ */
+
+#include "oneg4taskiconcache.h"
+
+#include <OneG4/Settings.h>
+#include <OneG4/XdgIcon.h>
+
+#include <QCoreApplication>
+
+#include "../panel/backends/ioneg4abstractwmiface.h"
+
+namespace {
+// enough for a few hundred distinct applications at common icon sizes
+const int kMaxCacheBytes = 8 * 1024 * 1024;
+}  // namespace
+
+/************************************************
+
+ ************************************************/
+OneG4TaskIconCache* OneG4TaskIconCache::instance() {
+  static OneG4TaskIconCache* cache = new OneG4TaskIconCache(qApp);
+  return cache;
+}
+
+/************************************************
+
+ ************************************************/
+OneG4TaskIconCache::OneG4TaskIconCache(QObject* parent) : QObject(parent), mCache(kMaxCacheBytes) {
+  connect(OneG4::Settings::globalSettings(), &OneG4::GlobalSettings::iconThemeChanged, this, [this] {
+    mCache.clear();
+    emit iconsInvalidated();
+  });
+}
+
+/************************************************
+
+ ************************************************/
+QString OneG4TaskIconCache::sourceKey(IOneG4AbstractWMInterface* backend, WId window) {
+  const QString windowClass = backend->getWindowClass(window);
+  if (windowClass.isEmpty())
+    return QStringLiteral("wid:%1").arg(window);
+  return QStringLiteral("class:%1").arg(windowClass);
+}
+
+/************************************************
+
+ ************************************************/
+QIcon OneG4TaskIconCache::icon(IOneG4AbstractWMInterface* backend,
+                               WId window,
+                               int iconSize,
+                               qreal dpr,
+                               bool byClass,
+                               QString* key) {
+  // one arg() call, the class may contain markers a chained call would substitute
+  const QString iconKey = QStringLiteral("%1|%2|%3|%4")
+                              .arg(sourceKey(backend, window), QString::number(iconSize), QString::number(dpr),
+                                   byClass ? QStringLiteral("t") : QStringLiteral("w"));
+  if (key)
+    *key = iconKey;
+
+  if (const QIcon* cached = mCache.object(iconKey))
+    return *cached;
+
+  const int devicePixels = iconSize * dpr;
+
+  if (byClass) {
+    const QIcon themed = XdgIcon::fromTheme(backend->getWindowClass(window).toLower());
+    if (!themed.isNull()) {
+      insert(iconKey, themed, devicePixels);
+      return themed;
+    }
+  }
+
+  if (mPendingKeys.contains(iconKey))
+    return XdgIcon::defaultApplicationIcon();
+
+  if (backend->requestApplicationIcon(window, devicePixels)) {
+    connect(backend, &IOneG4AbstractWMInterface::windowIconReady, this, &OneG4TaskIconCache::onWindowIconReady,
+            Qt::UniqueConnection);
+    connect(backend, &IOneG4AbstractWMInterface::windowIconRequestsCancelled, this,
+            &OneG4TaskIconCache::onWindowIconRequestsCancelled, Qt::UniqueConnection);
+    PendingRequest& request = mPendingRequests[qMakePair(window, devicePixels)];
+    request.backend = backend;
+    request.keys.append(iconKey);
+    mPendingKeys.insert(iconKey);
+    return XdgIcon::defaultApplicationIcon();
+  }
+
+  QIcon ico = backend->getApplicationIcon(window, devicePixels);
+  if (ico.isNull())
+    ico = XdgIcon::defaultApplicationIcon();
+
+  insert(iconKey, ico, devicePixels);
+  return ico;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskIconCache::invalidate(IOneG4AbstractWMInterface* backend, WId window) {
+  const QString prefix = sourceKey(backend, window) + QLatin1Char('|');
+  const auto keys = mCache.keys();
+  for (const QString& key : keys) {
+    if (key.startsWith(prefix))
+      mCache.remove(key);
+  }
+
+  // answers to requests made before the change are stale
+  for (auto it = mPendingKeys.begin(); it != mPendingKeys.end();) {
+    if (it->startsWith(prefix))
+      it = mPendingKeys.erase(it);
+    else
+      ++it;
+  }
+  for (auto it = mPendingRequests.begin(); it != mPendingRequests.end();) {
+    if (it.key().first == window && it->backend == backend)
+      it = mPendingRequests.erase(it);
+    else
+      ++it;
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskIconCache::insert(const QString& key, const QIcon& icon, int devicePixels) {
+  mCache.insert(key, new QIcon(icon), qMax(1, devicePixels * devicePixels * 4));
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskIconCache::onWindowIconRequestsCancelled(WId window) {
+  // the keys are shared by the class, the next window of it asks again
+  for (auto it = mPendingRequests.begin(); it != mPendingRequests.end();) {
+    if (it.key().first == window) {
+      for (const QString& key : std::as_const(it->keys))
+        mPendingKeys.remove(key);
+      it = mPendingRequests.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskIconCache::onWindowIconReady(WId window, int devicePixels, const QIcon& icon) {
+  const PendingRequest request = mPendingRequests.take(qMakePair(window, devicePixels));
+  if (!request.backend)
+    return;
+
+  QIcon ico = icon;
+  // no usable _NET_WM_ICON, the synchronous path knows more fallbacks
+  if (ico.isNull())
+    ico = request.backend->getApplicationIcon(window, devicePixels);
+  if (ico.isNull())
+    ico = XdgIcon::defaultApplicationIcon();
+
+  for (const QString& key : request.keys) {
+    if (!mPendingKeys.remove(key))
+      continue;
+    insert(key, ico, devicePixels);
+    emit iconReady(key);
+  }
+}
@@ -0,0 +1,71 @@
+/* plugin-taskbar/oneg4taskiconcache.h
+ * Taskbar plugin implementation
+ */
+
+#ifndef ONEG4TASKICONCACHE_H
+#define ONEG4TASKICONCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QIcon>
+#include <QObject>
+#include <QSet>
+
+#include "../panel/backends/oneg4taskbartypes.h"
+
+class IOneG4AbstractWMInterface;
+
+/*!
+ * \brief Process wide cache of task button icons.
+ *
+ * Shared by all taskbars on all panels. Icons are keyed by the window class (or the window
+ * itself if it has no class), the icon size and the device pixel ratio, so all windows of
+ * an application share one decoded icon. The cost of an entry is its pixel data size.
+ *
+ * Window icons are requested from the backend asynchronously where supported: a miss
+ * returns a placeholder and iconReady() announces the real icon.
+ */
+class OneG4TaskIconCache : public QObject {
+  Q_OBJECT
+
+ public:
+  static OneG4TaskIconCache* instance();
+
+  // Returns the icon of window, looked up in the icon theme by class first if byClass is set.
+  // The key the icon is stored under is returned through key, see iconReady().
+  QIcon icon(IOneG4AbstractWMInterface* backend,
+             WId window,
+             int iconSize,
+             qreal dpr,
+             bool byClass,
+             QString* key = nullptr);
+
+  // Drops the entries the window shares with its class, e.g. when its icon property changed
+  void invalidate(IOneG4AbstractWMInterface* backend, WId window);
+
+ signals:
+  // All entries were dropped, buttons have to fetch their icon again
+  void iconsInvalidated();
+  // The icon stored under key is available now, buttons showing the placeholder should refetch
+  void iconReady(const QString& key);
+
+ private:
+  explicit OneG4TaskIconCache(QObject* parent = nullptr);
+
+  static QString sourceKey(IOneG4AbstractWMInterface* backend, WId window);
+
+  void insert(const QString& key, const QIcon& icon, int devicePixels);
+  void onWindowIconReady(WId window, int devicePixels, const QIcon& icon);
+  void onWindowIconRequestsCancelled(WId window);
+
+  struct PendingRequest {
+    IOneG4AbstractWMInterface* backend = nullptr;
+    QStringList keys;
+  };
+
+  QCache<QString, QIcon> mCache;
+  QHash<QPair<WId, int>, PendingRequest> mPendingRequests;
+  QSet<QString> mPendingKeys;
+};
+
+#endif  // ONEG4TASKICONCACHE_H
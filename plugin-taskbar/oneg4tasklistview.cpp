@@ -0,0 +1,528 @@
+/* plugin-taskbar/oneg4tasklistview.cpp
+ * Taskbar plugin implementation
+ */
+
+#include "oneg4tasklistview.h"
+#include "oneg4taskbar.h"
+#include "oneg4taskiconcache.h"
+
+#include "../panel/ioneg4panelplugin.h"
+
+#include <QContextMenuEvent>
+#include <QHelpEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QToolTip>
+#include <OneG4/XdgIcon.h>
+#include <algorithm>
+
+#include "../panel/backends/ioneg4abstractwmiface.h"
+
+namespace {
+QColor mixColors(const QColor& from, const QColor& to, qreal progress) {
+  return QColor::fromRgbF(from.redF() + (to.redF() - from.redF()) * progress,
+                          from.greenF() + (to.greenF() - from.greenF()) * progress,
+                          from.blueF() + (to.blueF() - from.blueF()) * progress,
+                          from.alphaF() + (to.alphaF() - from.alphaF()) * progress);
+}
+}  // namespace
+
+/************************************************
+
+ ************************************************/
+OneG4TaskListView::OneG4TaskListView(OneG4TaskBar* taskBar)
+    : QWidget(taskBar),
+      mTaskBar(taskBar),
+      mBackend(taskBar->getBackend()),
+      mColumns(1),
+      mIconSize(taskBar->panel()->iconSize()),
+      mOpacity(taskBar->buttonOpacity()),
+      mHoverWindow(0),
+      mPressedWindow(0) {
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+  setMinimumSize(1, 1);
+  setMouseTracking(true);
+
+  connect(OneG4TaskIconCache::instance(), &OneG4TaskIconCache::iconsInvalidated, this,
+          &OneG4TaskListView::updateIcons);
+  connect(OneG4TaskIconCache::instance(), &OneG4TaskIconCache::iconReady, this, [this](const QString& key) {
+    for (Task& task : mTasks) {
+      if (task.iconKey == key) {
+        updateIcon(task);
+        update(task.rect);
+      }
+    }
+  });
+  connect(mTaskBar, &OneG4TaskBar::iconByClassChanged, this, &OneG4TaskListView::updateIcons);
+  connect(mTaskBar, &OneG4TaskBar::buttonStyleRefreshed, this, &OneG4TaskListView::realign);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::addWindow(WId window) {
+  if (mIndex.contains(window))
+    return;
+
+  Task task;
+  task.window = window;
+  task.title = mBackend->getWindowTitle(window);
+  updateIcon(task);
+  setFlag(task, Visible, mTaskBar->isWindowVisible(window));
+  setFlag(task, Active, mBackend->isWindowActive(window));
+  setFlag(task, Urgent, mBackend->applicationDemandsAttention(window));
+  setFlag(task, Minimized, mBackend->getWindowState(window) == OneG4TaskBarWindowState::Minimized);
+  if (task.flags & Urgent)
+    mTaskBar->startUrgencyBlink();
+
+  mIndex.insert(window, mTasks.count());
+  mTasks.append(task);
+  if (task.flags & Visible) {
+    // the cells of the other tasks may shrink
+    relayout();
+    update();
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::removeWindow(WId window) {
+  const int index = mIndex.value(window, -1);
+  if (index < 0)
+    return;
+
+  const bool visible = mTasks.at(index).flags & Visible;
+  mTasks.remove(index);
+  mIndex.remove(window);
+  for (int i = index; i < mTasks.count(); ++i)
+    mIndex[mTasks.at(i).window] = i;
+
+  if (mHoverWindow == window)
+    mHoverWindow = 0;
+  if (mPressedWindow == window)
+    mPressedWindow = 0;
+
+  // the slots hold positions, they have to be rebuilt even for a hidden task
+  relayout();
+  if (visible)
+    update();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::onWindowChanged(WId window, int props) {
+  const int index = mIndex.value(window, -1);
+  if (index < 0)
+    return;
+
+  auto changed = [props](OneG4TaskBarWindowProperty prop) { return props & windowPropertyMask(prop); };
+
+  Task& task = mTasks[index];
+  if (changed(OneG4TaskBarWindowProperty::Title))
+    task.title = mBackend->getWindowTitle(window);
+  if (changed(OneG4TaskBarWindowProperty::Icon))
+    updateIcon(task);
+  if (changed(OneG4TaskBarWindowProperty::Urgency) || changed(OneG4TaskBarWindowProperty::State)) {
+    setFlag(task, Urgent, mBackend->applicationDemandsAttention(window));
+    if (task.flags & Urgent)
+      mTaskBar->startUrgencyBlink();
+  }
+  if (changed(OneG4TaskBarWindowProperty::State))
+    setFlag(task, Minimized, mBackend->getWindowState(window) == OneG4TaskBarWindowState::Minimized);
+
+  // only the cell of the window is repainted
+  if (changed(OneG4TaskBarWindowProperty::Title) || changed(OneG4TaskBarWindowProperty::Icon) ||
+      changed(OneG4TaskBarWindowProperty::Urgency) || changed(OneG4TaskBarWindowProperty::State))
+    update(task.rect);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::onActiveWindowChanged(WId window) {
+  for (Task& task : mTasks) {
+    const bool active = task.window == window;
+    if (bool(task.flags & Active) == active)
+      continue;
+
+    setFlag(task, Active, active);
+    if (active)
+      setFlag(task, Urgent, false);
+    update(task.rect);
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::refreshVisibility() {
+  bool changed = false;
+  for (Task& task : mTasks) {
+    const bool visible = mTaskBar->isWindowVisible(task.window);
+    if (bool(task.flags & Visible) != visible) {
+      setFlag(task, Visible, visible);
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    relayout();
+    update();
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::refreshIconsGeometry(QHash<WId, QRect>& geometries) const {
+  const QPoint origin = mapToGlobal(QPoint(0, 0));
+  for (int index : mSlots) {
+    const Task& task = mTasks.at(index);
+    geometries.insert(task.window, task.rect.translated(origin));
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::activateTask(int pos) {
+  if (pos < 1 || pos > mSlots.count())
+    return;
+
+  mBackend->raiseWindow(mTasks.at(mSlots.at(pos - 1)).window, mTaskBar->raiseOnCurrentDesktop());
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::cycleTasks(bool next) {
+  if (mSlots.isEmpty())
+    return;
+
+  int slot = -1;
+  for (int i = 0; i < mSlots.count() && slot < 0; ++i) {
+    if (mTasks.at(mSlots.at(i)).flags & Active)
+      slot = i;
+  }
+
+  if (slot < 0)
+    slot = next ? 0 : mSlots.count() - 1;
+  else
+    slot = (slot + (next ? 1 : -1) + mSlots.count()) % mSlots.count();
+  mBackend->raiseWindow(mTasks.at(mSlots.at(slot)).window, mTaskBar->raiseOnCurrentDesktop());
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::setOpacity(qreal opacity) {
+  mOpacity = std::clamp(opacity, 0.0, 1.0);
+  update();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::realign() {
+  relayout();
+  update();
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::updateIcon(Task& task) {
+  task.icon = OneG4TaskIconCache::instance()->icon(mBackend, task.window, mIconSize, devicePixelRatioF(),
+                                                   mTaskBar->isIconByClass(), &task.iconKey);
+}
+
+void OneG4TaskListView::updateIcons() {
+  for (Task& task : mTasks)
+    updateIcon(task);
+  update();
+}
+
+void OneG4TaskListView::setFlag(Task& task, TaskFlag flag, bool set) {
+  if (set)
+    task.flags |= flag;
+  else
+    task.flags &= ~flag;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::relayout() {
+  mSlots.clear();
+  for (int i = 0; i < mTasks.count(); ++i) {
+    if (mTasks.at(i).flags & Visible)
+      mSlots.append(i);
+    else
+      mTasks[i].rect = QRect();
+  }
+
+  const int count = mSlots.count();
+  if (count == 0)
+    return;
+
+  // same grid the task groups get from the taskbar's layout, see OneG4TaskBar::realign()
+  IOneG4Panel* panel = mTaskBar->panel();
+  const int lines = std::max(1, panel->lineCount());
+  int rows = 1;
+  if (panel->isHorizontal()) {
+    rows = std::min(lines, count);
+    mColumns = (count + rows - 1) / rows;
+  }
+  else {
+    mColumns = mTaskBar->buttonStyle() == Qt::ToolButtonIconOnly ? std::min(lines, count) : 1;
+    rows = (count + mColumns - 1) / mColumns;
+  }
+
+  mCellSize = QSize(std::max(1, std::min(mTaskBar->buttonWidth(), width() / mColumns)),
+                    std::max(1, std::min(mTaskBar->buttonHeight(), height() / rows)));
+  for (int slot = 0; slot < count; ++slot) {
+    const QPoint topLeft((slot % mColumns) * mCellSize.width(), (slot / mColumns) * mCellSize.height());
+    mTasks[mSlots.at(slot)].rect = QRect(topLeft, mCellSize);
+  }
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4TaskListView::repaintUrgentTasks() {
+  bool urgent = false;
+  for (const Task& task : std::as_const(mTasks)) {
+    if (task.flags & Urgent) {
+      update(task.rect);
+      urgent = true;
+    }
+  }
+  return urgent;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::repaintTask(WId window) {
+  const int index = mIndex.value(window, -1);
+  if (index >= 0)
+    update(mTasks.at(index).rect);
+}
+
+/************************************************
+
+ ************************************************/
+int OneG4TaskListView::taskAt(const QPoint& pos) const {
+  if (mSlots.isEmpty() || pos.x() < 0 || pos.y() < 0)
+    return -1;
+
+  const int column = pos.x() / mCellSize.width();
+  if (column >= mColumns)
+    return -1;
+
+  const int slot = (pos.y() / mCellSize.height()) * mColumns + column;
+  return slot < mSlots.count() ? mSlots.at(slot) : -1;
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4TaskListView::event(QEvent* event) {
+  if (event->type() == QEvent::ToolTip) {
+    QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+    const int index = taskAt(helpEvent->pos());
+    if (index >= 0)
+      QToolTip::showText(helpEvent->globalPos(), mTasks.at(index).title, this, mTasks.at(index).rect);
+    else
+      QToolTip::hideText();
+    return true;
+  }
+  return QWidget::event(event);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::changeEvent(QEvent* event) {
+  // the panel signals an icon size change through a stylesheet update only
+  if (event->type() == QEvent::StyleChange) {
+    const int iconSize = mTaskBar->panel()->iconSize();
+    if (iconSize != mIconSize) {
+      mIconSize = iconSize;
+      updateIcons();
+    }
+  }
+  QWidget::changeEvent(event);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::paintEvent(QPaintEvent* event) {
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing, true);
+  const QRect dirty = event->rect();
+  for (int index : std::as_const(mSlots)) {
+    const Task& task = mTasks.at(index);
+    if (task.rect.intersects(dirty))
+      paintTask(painter, task);
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::paintTask(QPainter& painter, const Task& task) const {
+  // the same look as OneG4TaskButton::paintEvent() without the hover animation
+  const QPalette& pal = palette();
+  const QColor accent = pal.color(QPalette::Highlight);
+  QColor base = pal.color(QPalette::Button);
+  QColor border = pal.color(QPalette::Mid);
+
+  if (task.flags & Active) {
+    base = base.darker(105);
+    border = border.darker(110);
+  }
+  // the blink shows urgent tasks as normal ones every other phase
+  const bool urgent = (task.flags & Urgent) && !mTaskBar->isUrgencyBlinkOff();
+  if (urgent) {
+    base = mTaskBar->urgentPalette().color(QPalette::Button);
+    border = base.darker(120);
+  }
+  else if (task.window == mHoverWindow) {
+    base = mixColors(base, accent.lighter(125), 0.45);
+    border = mixColors(border, accent, 0.7);
+  }
+
+  base.setAlphaF(mOpacity);
+  border.setAlphaF(mOpacity);
+
+  const QRect frame = task.rect.adjusted(1, 1, -1, -1);
+  painter.setPen(QPen(border, 1));
+  painter.setBrush(base);
+  painter.drawRoundedRect(frame, 3, 3);
+
+  const Qt::ToolButtonStyle style = mTaskBar->buttonStyle();
+  QRect content = frame.adjusted(3, 2, -3, -2);
+  if (style != Qt::ToolButtonTextOnly) {
+    const int size = std::min(mIconSize, content.height());
+    QRect iconRect(0, 0, size, size);
+    if (style == Qt::ToolButtonIconOnly)
+      iconRect.moveCenter(content.center());
+    else
+      iconRect.moveTopLeft(QPoint(content.left(), content.top() + (content.height() - size) / 2));
+    task.icon.paint(&painter, iconRect, Qt::AlignCenter,
+                    task.flags & Minimized ? QIcon::Disabled : QIcon::Normal);
+    content.setLeft(iconRect.right() + 4);
+  }
+
+  if (style != Qt::ToolButtonIconOnly && content.width() > 0) {
+    if (urgent)
+      painter.setPen(mTaskBar->urgentPalette().color(QPalette::ButtonText));
+    else
+      painter.setPen(pal.color(task.flags & Minimized ? QPalette::PlaceholderText : QPalette::ButtonText));
+    const QString text = painter.fontMetrics().elidedText(task.title, Qt::ElideRight, content.width());
+    painter.drawText(content, Qt::AlignLeft | Qt::AlignVCenter, text);
+  }
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::resizeEvent(QResizeEvent* event) {
+  relayout();
+  QWidget::resizeEvent(event);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::mousePressEvent(QMouseEvent* event) {
+  const int index = taskAt(event->position().toPoint());
+  if (index < 0)
+    return QWidget::mousePressEvent(event);
+
+  const WId window = mTasks.at(index).window;
+  if (event->button() == Qt::LeftButton)
+    mPressedWindow = window;
+  else if (event->button() == Qt::MiddleButton && mTaskBar->closeOnMiddleClick())
+    mBackend->closeWindow(window);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::mouseReleaseEvent(QMouseEvent* event) {
+  const WId pressed = mPressedWindow;
+  mPressedWindow = 0;
+  if (event->button() != Qt::LeftButton || pressed == 0)
+    return QWidget::mouseReleaseEvent(event);
+
+  const int index = taskAt(event->position().toPoint());
+  if (index < 0 || mTasks.at(index).window != pressed)
+    return;
+
+  // a click toggles the window like a checkable task button
+  if (mTasks.at(index).flags & Active)
+    mBackend->setWindowState(pressed, OneG4TaskBarWindowState::Minimized, true);
+  else
+    mBackend->raiseWindow(pressed, mTaskBar->raiseOnCurrentDesktop());
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::mouseMoveEvent(QMouseEvent* event) {
+  const int index = taskAt(event->position().toPoint());
+  const WId hover = index >= 0 ? mTasks.at(index).window : 0;
+  if (hover != mHoverWindow) {
+    const WId previous = mHoverWindow;
+    mHoverWindow = hover;
+    repaintTask(previous);
+    repaintTask(hover);
+  }
+  QWidget::mouseMoveEvent(event);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::leaveEvent(QEvent* event) {
+  const WId previous = mHoverWindow;
+  mHoverWindow = 0;
+  repaintTask(previous);
+  QWidget::leaveEvent(event);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4TaskListView::contextMenuEvent(QContextMenuEvent* event) {
+  const int index = taskAt(event->pos());
+  if (index < 0)
+    return;
+
+  const WId window = mTasks.at(index).window;
+  QMenu* menu = new QMenu(tr("Application"));
+  menu->setAttribute(Qt::WA_DeleteOnClose);
+  if (mTasks.at(index).flags & Minimized) {
+    connect(menu->addAction(tr("Restore")), &QAction::triggered, this,
+            [this, window] { mBackend->raiseWindow(window, mTaskBar->raiseOnCurrentDesktop()); });
+  }
+  else {
+    connect(menu->addAction(tr("Mi&nimize")), &QAction::triggered, this,
+            [this, window] { mBackend->setWindowState(window, OneG4TaskBarWindowState::Minimized, true); });
+  }
+  menu->addSeparator();
+  connect(menu->addAction(XdgIcon::fromTheme(QStringLiteral("process-stop")), tr("&Close")), &QAction::triggered,
+          this, [this, window] { mBackend->closeWindow(window); });
+
+  IOneG4PanelPlugin* plugin = mTaskBar->plugin();
+  menu->setGeometry(plugin->panel()->calculatePopupWindowPos(mapToGlobal(event->pos()), menu->sizeHint()));
+  plugin->willShowWindow(menu);
+  menu->show();
+}
@@ -0,0 +1,102 @@
+/* plugin-taskbar/oneg4tasklistview.h
+ * Taskbar plugin implementation
+ */
+
+#ifndef ONEG4TASKLISTVIEW_H
+#define ONEG4TASKLISTVIEW_H
+
+#include <QHash>
+#include <QIcon>
+#include <QVector>
+#include <QWidget>
+
+class OneG4TaskBar;
+class IOneG4AbstractWMInterface;
+
+/*!
+ * \brief Single widget showing all the tasks of a taskbar, one painted cell per window.
+ *
+ * Used instead of the task groups when "paintedTaskList" is set: there is no widget, style
+ * polish or layout item per window, the cells are laid out, painted and hit-tested here
+ * from a flat array of task records. Windows are not grouped in this mode.
+ *
+ * The taskbar keeps feeding the window events and owns the filters, see
+ * OneG4TaskBar::isWindowVisible().
+ */
+class OneG4TaskListView : public QWidget {
+  Q_OBJECT
+
+ public:
+  explicit OneG4TaskListView(OneG4TaskBar* taskBar);
+
+  bool contains(WId window) const { return mIndex.contains(window); }
+  bool hasVisibleTasks() const { return !mSlots.isEmpty(); }
+
+  void addWindow(WId window);
+  void removeWindow(WId window);
+  // props is a mask of windowPropertyMask() bits
+  void onWindowChanged(WId window, int props);
+  void onActiveWindowChanged(WId window);
+  // Re-reads the visibility of every task from the taskbar
+  void refreshVisibility();
+
+  // Adds where the cells of the visible tasks are, the taskbar publishes them in one batch
+  void refreshIconsGeometry(QHash<WId, QRect>& geometries) const;
+  // Repaints the urgent tasks for the blink, returns false if there is none
+  bool repaintUrgentTasks();
+
+  // pos counts the visible tasks from 1
+  void activateTask(int pos);
+  void cycleTasks(bool next);
+  void setOpacity(qreal opacity);
+  // Panel orientation, line count or button sizes changed
+  void realign();
+
+ protected:
+  bool event(QEvent* event) override;
+  void changeEvent(QEvent* event) override;
+  void paintEvent(QPaintEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
+  void mousePressEvent(QMouseEvent* event) override;
+  void mouseReleaseEvent(QMouseEvent* event) override;
+  void mouseMoveEvent(QMouseEvent* event) override;
+  void leaveEvent(QEvent* event) override;
+  void contextMenuEvent(QContextMenuEvent* event) override;
+
+ private:
+  enum TaskFlag : quint8 { Visible = 0x1, Active = 0x2, Urgent = 0x4, Minimized = 0x8 };
+
+  struct Task {
+    WId window = 0;
+    quint8 flags = 0;
+    QRect rect;  //!< cell, empty while hidden
+    QString title;
+    QString iconKey;  //!< OneG4TaskIconCache key of icon
+    QIcon icon;
+  };
+
+  void updateIcon(Task& task);
+  void updateIcons();
+  void setFlag(Task& task, TaskFlag flag, bool set);
+  // Lays the visible tasks out in cells, in task order
+  void relayout();
+  void repaintTask(WId window);
+  int taskAt(const QPoint& pos) const;
+  void paintTask(QPainter& painter, const Task& task) const;
+
+  OneG4TaskBar* mTaskBar;
+  IOneG4AbstractWMInterface* mBackend;
+
+  QVector<Task> mTasks;      //!< in the order the windows were added
+  QHash<WId, int> mIndex;    //!< position of each window in mTasks
+  QVector<int> mSlots;       //!< mTasks positions of the visible tasks, cell by cell
+  QSize mCellSize;
+  int mColumns;
+  int mIconSize;
+  qreal mOpacity;
+
+  WId mHoverWindow;
+  WId mPressedWindow;
+};
+
+#endif  // ONEG4TASKLISTVIEW_H
@@ -0,0 +1,170 @@
+/* plugin-taskbar/oneg4windowmatcher.cpp
+ * Taskbar plugin implementation
+ */
+
+#include "oneg4windowmatcher.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace {
+// Groups referred to by number or name mean something else once joined with other expressions
+const QRegularExpression kGroupReference(QStringLiteral("\\\\[1-9gk]|\\(\\?P?[<'][A-Za-z_]|\\(\\?P[=>]"));
+}  // namespace
+
+/************************************************
+
+ ************************************************/
+QStringList OneG4WindowMatcher::splitPatterns(const QString& list) {
+  QStringList patterns;
+  QString current;
+  bool inExpression = false;
+  for (int i = 0; i < list.size(); ++i) {
+    const QChar c = list.at(i);
+    if (inExpression) {
+      current += c;
+      if (c == QLatin1Char('\\') && i + 1 < list.size()) {
+        current += list.at(++i);
+      }
+      else if (c == QLatin1Char('/')) {
+        // the closing slash is the last character of the entry
+        int next = i + 1;
+        while (next < list.size() && list.at(next).isSpace())
+          ++next;
+        inExpression = next < list.size() && list.at(next) != QLatin1Char(',');
+      }
+    }
+    else if (c == QLatin1Char(',')) {
+      if (!current.trimmed().isEmpty())
+        patterns.append(current.trimmed());
+      current.clear();
+    }
+    else {
+      current += c;
+      if (c == QLatin1Char('/')) {
+        // an opening slash starts the entry, after the optional "title:"
+        QString head = current.trimmed();
+        if (head.startsWith(QLatin1String("title:"), Qt::CaseInsensitive))
+          head = head.mid(6).trimmed();
+        inExpression = head == QLatin1String("/");
+      }
+    }
+  }
+  if (!current.trimmed().isEmpty())
+    patterns.append(current.trimmed());
+  return patterns;
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4WindowMatcher::setPatterns(const QStringList& patterns) {
+  mPatterns = patterns;
+  mClassVerdicts.clear();
+  mClassRules = Rules();
+  mTitleRules = Rules();
+
+  QStringList classGlobs, classExpressions, titleGlobs, titleExpressions;
+  for (const QString& entry : patterns) {
+    QString pattern = entry.trimmed();
+    const bool title = pattern.startsWith(QLatin1String("title:"), Qt::CaseInsensitive);
+    if (title)
+      pattern = pattern.mid(6).trimmed();
+    if (pattern.isEmpty())
+      continue;
+
+    Rules& rules = title ? mTitleRules : mClassRules;
+    if (pattern.size() > 2 && pattern.startsWith(QLatin1Char('/')) && pattern.endsWith(QLatin1Char('/'))) {
+      const QString expression = pattern.mid(1, pattern.size() - 2);
+      if (QRegularExpression(expression).isValid())
+        (title ? titleExpressions : classExpressions).append(expression);
+      else
+        qWarning() << "Ignoring invalid window pattern" << entry;
+    }
+    else if (pattern.contains(QLatin1Char('*')) || pattern.contains(QLatin1Char('?')) ||
+             pattern.contains(QLatin1Char('['))) {
+      (title ? titleGlobs : classGlobs).append(pattern);
+    }
+    else {
+      rules.names.insert(pattern.toCaseFolded());
+    }
+  }
+
+  compile(mClassRules, classGlobs, classExpressions);
+  compile(mTitleRules, titleGlobs, titleExpressions);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4WindowMatcher::compile(Rules& rules, const QStringList& globs, const QStringList& expressions) {
+  // globs come out anchored, expressions are searched anywhere like with grep
+  QStringList alternatives;
+  for (const QString& glob : globs)
+    alternatives.append(
+        QRegularExpression::wildcardToRegularExpression(glob, QRegularExpression::NonPathWildcardConversion));
+  for (const QString& expression : expressions) {
+    if (expression.contains(kGroupReference))
+      addSeparate(rules, expression);
+    else
+      alternatives.append(expression);
+  }
+  if (alternatives.isEmpty())
+    return;
+
+  rules.pattern.setPattern(QStringLiteral("(?:") + alternatives.join(QStringLiteral(")|(?:")) + QLatin1Char(')'));
+  rules.pattern.setPatternOptions(QRegularExpression::CaseInsensitiveOption |
+                                  QRegularExpression::DontCaptureOption);
+  if (rules.pattern.isValid()) {
+    rules.pattern.optimize();
+    return;
+  }
+
+  qWarning() << "Window patterns cannot be combined, matching them one by one:" << rules.pattern.errorString();
+  rules.pattern = QRegularExpression();
+  for (const QString& alternative : std::as_const(alternatives))
+    addSeparate(rules, alternative);
+}
+
+/************************************************
+
+ ************************************************/
+void OneG4WindowMatcher::addSeparate(Rules& rules, const QString& expression) {
+  QRegularExpression separate(expression, QRegularExpression::CaseInsensitiveOption);
+  separate.optimize();
+  rules.separate.append(separate);
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4WindowMatcher::Rules::matches(const QString& text) const {
+  if (names.contains(text.toCaseFolded()))
+    return true;
+  if (!pattern.pattern().isEmpty() && pattern.match(text).hasMatch())
+    return true;
+  return std::any_of(separate.cbegin(), separate.cend(), [&text](const QRegularExpression& expression) {
+    return expression.match(text).hasMatch();
+  });
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4WindowMatcher::matchesClass(const QString& windowClass) const {
+  if (mClassRules.isEmpty())
+    return false;
+
+  auto i = mClassVerdicts.constFind(windowClass);
+  if (mClassVerdicts.cend() == i)
+    i = mClassVerdicts.insert(windowClass, mClassRules.matches(windowClass));
+  return *i;
+}
+
+/************************************************
+
+ ************************************************/
+bool OneG4WindowMatcher::matchesTitle(const QString& title) const {
+  return !mTitleRules.isEmpty() && mTitleRules.matches(title);
+}
@@ -0,0 +1,60 @@
+/* plugin-taskbar/oneg4windowmatcher.h
+ * Taskbar plugin implementation
+ */
+
+#ifndef ONEG4WINDOWMATCHER_H
+#define ONEG4WINDOWMATCHER_H
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief Compiled list of window class and title patterns, e.g. the taskbar exclusion list.
+ *
+ * Each pattern is one of
+ *  - a class name, compared case insensitively,
+ *  - a glob with '*', '?' or '[...]', matching the whole class,
+ *  - a regular expression between slashes, e.g. "/^steam_app_\d+$/", searched in the class,
+ * optionally prefixed by "title:" to apply to the window title instead of the class.
+ *
+ * The names go to a hash of case folded strings and all the other patterns of a kind are
+ * joined into one regular expression, so matching costs the same whatever the list length.
+ * Class verdicts are remembered until the patterns change.
+ */
+class OneG4WindowMatcher {
+ public:
+  // Splits a comma separated list, commas inside a regular expression do not separate entries
+  static QStringList splitPatterns(const QString& list);
+
+  void setPatterns(const QStringList& patterns);
+  const QStringList& patterns() const { return mPatterns; }
+
+  bool isEmpty() const { return mPatterns.isEmpty(); }
+  // Titles change often and have to be fetched, callers skip them when no pattern needs them
+  bool matchesTitles() const { return !mTitleRules.isEmpty(); }
+
+  bool matchesClass(const QString& windowClass) const;
+  bool matchesTitle(const QString& title) const;
+
+ private:
+  struct Rules {
+    QSet<QString> names;         //!< case folded
+    QRegularExpression pattern;  //!< alternation of the globs and expressions, empty if none
+    QVector<QRegularExpression> separate;  //!< expressions that cannot be part of the alternation
+    bool isEmpty() const { return names.isEmpty() && pattern.pattern().isEmpty() && separate.isEmpty(); }
+    bool matches(const QString& text) const;
+  };
+
+  static void compile(Rules& rules, const QStringList& globs, const QStringList& expressions);
+  static void addSeparate(Rules& rules, const QString& expression);
+
+  QStringList mPatterns;
+  Rules mClassRules;
+  Rules mTitleRules;
+  mutable QHash<QString, bool> mClassVerdicts;
+};
+
+#endif  // ONEG4WINDOWMATCHER_H